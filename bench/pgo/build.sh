@@ -0,0 +1,33 @@
+#!/bin/sh
+# Сборка mini_shell с PGO + LTO:
+#   1. инструментированная сборка (PGO_MODE=GENERATE),
+#   2. прогон обучающего корпуса (train.sh),
+#   3. пересборка в том же каталоге с профилем (PGO_MODE=USE).
+#
+# Использование: bench/pgo/build.sh [BUILD_DIR]   (по умолчанию build-pgo)
+set -eu
+
+root=$(cd "$(dirname "$0")/../.." && pwd)
+build=${1:-$root/build-pgo}
+profile=$build/pgo-profile
+
+rm -rf "$profile"
+cmake -S "$root" -B "$build" -DCMAKE_BUILD_TYPE=Release -DENABLE_LTO=ON \
+    -DBUILD_TESTING=OFF -DPGO_MODE=GENERATE -DPGO_PROFILE_DIR="$profile"
+cmake --build "$build" --clean-first -j
+
+"$root/bench/pgo/train.sh" "$build/mini_shell"
+
+# Без профиля стадия USE молча дала бы обычную сборку -O3 + LTO
+if ! find "$profile" \( -name '*.gcda' -o -name '*.profraw' \) 2> /dev/null | grep -q .; then
+    echo "build.sh: training left no profile in $profile" >&2
+    exit 1
+fi
+
+# Clang пишет сырые .profraw, их нужно слить; GCC читает .gcda напрямую
+if ls "$profile"/*.profraw > /dev/null 2>&1; then
+    llvm-profdata merge -o "$profile/default.profdata" "$profile"/*.profraw
+fi
+
+cmake -S "$root" -B "$build" -DPGO_MODE=USE
+cmake --build "$build" --clean-first -j
@@ -0,0 +1,38 @@
+#!/bin/sh
+# Сравнение времени прогона корпуса двумя сборками mini_shell.
+# Корпус (make_corpus.sh, REPEAT повторов) строится один раз; измеряются только
+# запуски mini_shell с файлом корпуса на stdin, лучшее из RUNS.
+#
+# Использование: bench/pgo/compare.sh BASELINE_MINI_SHELL PGO_MINI_SHELL
+set -eu
+
+dir=$(cd "$(dirname "$0")" && pwd)
+runs=${RUNS:-5}
+input=$(mktemp -d)
+trap 'rm -rf "$input"' EXIT
+
+REPEAT=${REPEAT:-100000} "$dir/make_corpus.sh" "$input"
+
+measure() {
+    best=
+    i=0
+    while [ "$i" -lt "$runs" ]; do
+        start=$(date +%s%N)
+        for file in "$input"/*.txt; do
+            "$1" --stats < "$file" > /dev/null 2>&1
+        done
+        end=$(date +%s%N)
+        elapsed=$(((end - start) / 1000000))
+        if [ -z "$best" ] || [ "$elapsed" -lt "$best" ]; then
+            best=$elapsed
+        fi
+        i=$((i + 1))
+    done
+    echo "$best"
+}
+
+base=$(measure "$1")
+pgo=$(measure "$2")
+echo "lines:    $(cat "$input"/*.txt | wc -l)"
+echo "baseline: ${base} ms (best of $runs)"
+echo "pgo+lto:  ${pgo} ms (best of $runs)"
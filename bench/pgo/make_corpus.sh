@@ -0,0 +1,30 @@
+#!/bin/sh
+# Сборка входных файлов корпуса: каждый bench/pgo/corpus/*.txt повторяется REPEAT раз
+# и записывается в OUT_DIR под тем же именем. Файлы строятся один раз до замеров,
+# чтобы в измеряемое время не попадала генерация входа.
+#
+# Использование: bench/pgo/make_corpus.sh OUT_DIR   (REPEAT по умолчанию 2000)
+set -eu
+
+out=$1
+repeat=${REPEAT:-2000}
+corpus=$(cd "$(dirname "$0")" && pwd)/corpus
+
+mkdir -p "$out"
+for file in "$corpus"/*.txt; do
+    # Удвоение: log2(REPEAT) склеек вместо REPEAT запусков cat
+    cp "$file" "$out/chunk"
+    : > "$out/$(basename "$file")"
+    n=$repeat
+    while [ "$n" -gt 0 ]; do
+        if [ $((n % 2)) -eq 1 ]; then
+            cat "$out/chunk" >> "$out/$(basename "$file")"
+        fi
+        n=$((n / 2))
+        if [ "$n" -gt 0 ]; then
+            cat "$out/chunk" "$out/chunk" > "$out/chunk.next"
+            mv "$out/chunk.next" "$out/chunk"
+        fi
+    done
+    rm -f "$out/chunk"
+done
@@ -0,0 +1,16 @@
+#!/bin/sh
+# Прогон обучающего корпуса bench/pgo/corpus/*.txt через mini_shell.
+# Каждый файл, повторённый REPEAT раз (make_corpus.sh), подаётся на stdin одного процесса.
+#
+# Использование: bench/pgo/train.sh PATH_TO_MINI_SHELL
+set -eu
+
+shell=$1
+dir=$(cd "$(dirname "$0")" && pwd)
+input=$(mktemp -d)
+trap 'rm -rf "$input"' EXIT
+
+"$dir/make_corpus.sh" "$input"
+for file in "$input"/*.txt; do
+    "$shell" --stats < "$file" > /dev/null 2>&1
+done
@@ -0,0 +1,24 @@
+#!/bin/sh
+# Время запуска mini_shell: среднее по RUNS запускам.
+#   prompt   — запуск до первого приглашения и выход по EOF (mini_shell < /dev/null)
+#   -c true  — исполнение одной строки без REPL (mini_shell -c true)
+#
+# Использование: bench/startup.sh PATH_TO_MINI_SHELL
+set -eu
+
+shell=$1
+runs=${RUNS:-2000}
+
+measure() {
+    start=$(date +%s%N)
+    i=0
+    while [ "$i" -lt "$runs" ]; do
+        "$@" < /dev/null > /dev/null
+        i=$((i + 1))
+    done
+    end=$(date +%s%N)
+    echo $(((end - start) / runs / 1000))
+}
+
+echo "prompt:  $(measure "$shell") us"
+echo "-c true: $(measure "$shell" -c true) us"
@@ -1,7 +0,0 @@
-#pragma once
-
-class Shell {
-public:
-    // Запуск интерпретатора
-    int run();
-};
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include "completion.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+#if defined(__linux__)
+constexpr std::uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                     IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+#endif
+
+std::timespec modificationTime(const struct stat &st) {
+#if defined(__APPLE__)
+    return st.st_mtimespec;
+#else
+    return st.st_mtim;
+#endif
+}
+
+bool sameTime(const std::timespec &a, const std::timespec &b) {
+    return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+}
+
+// Исполняемый файл (не директория) в директории dirFd
+bool isExecutable(int dirFd, const char *name, unsigned char type) {
+    if (type == DT_DIR || faccessat(dirFd, name, X_OK, 0) != 0) {
+        return false;
+    }
+    if (type == DT_REG) {
+        return true;
+    }
+    // DT_LNK и DT_UNKNOWN: проверяем, куда ведёт имя
+    struct stat st {};
+    return fstatat(dirFd, name, &st, 0) == 0 && !S_ISDIR(st.st_mode);
+}
+
+void insertSorted(std::vector<std::string> &names, std::string name) {
+    const auto it = std::lower_bound(names.begin(), names.end(), name);
+    if (it == names.end() || *it != name) {
+        names.insert(it, std::move(name));
+    }
+}
+
+void eraseSorted(std::vector<std::string> &names, const std::string &name) {
+    const auto it = std::lower_bound(names.begin(), names.end(), name);
+    if (it != names.end() && *it == name) {
+        names.erase(it);
+    }
+}
+
+}  // namespace
+
+CompletionIndex::CompletionIndex() {
+#if defined(__linux__)
+    inotify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+CompletionIndex::~CompletionIndex() {
+    if (inotify_ >= 0) {
+        close(inotify_);
+    }
+}
+
+void CompletionIndex::setBuiltins(std::vector<std::string> names) {
+    builtins_ = std::move(names);
+    dirty_ = true;
+}
+
+void CompletionIndex::setPath(std::string_view path) {
+    std::vector<std::string> order;
+    while (!path.empty()) {
+        const std::size_t colon = path.find(':');
+        const std::string_view item = path.substr(0, colon);
+        // Пустой элемент PATH означает текущую директорию; её не индексируем
+        if (!item.empty() && std::find(order.begin(), order.end(), item) == order.end()) {
+            order.emplace_back(item);
+        }
+        path = colon == std::string_view::npos ? std::string_view() : path.substr(colon + 1);
+    }
+
+    const std::unordered_set<std::string> keep(order.begin(), order.end());
+    for (auto it = dirs_.begin(); it != dirs_.end();) {
+        if (keep.count(it->first) != 0) {
+            ++it;
+            continue;
+        }
+#if defined(__linux__)
+        // Другой элемент PATH может вести в ту же директорию и делить с ней watch
+        const int watch = it->second.watch;
+        const bool shared =
+            watch >= 0 && std::any_of(dirs_.begin(), dirs_.end(), [&](const auto &item) {
+                return &item.second != &it->second && item.second.watch == watch;
+            });
+        if (watch >= 0 && !shared) {
+            inotify_rm_watch(inotify_, watch);
+        }
+#endif
+        it = dirs_.erase(it);
+    }
+
+    for (const std::string &dirPath : order) {
+        if (dirs_.count(dirPath) != 0) {
+            continue;
+        }
+        Directory &dir = dirs_[dirPath];
+#if defined(__linux__)
+        // Watch ставится до сканирования, чтобы не пропустить изменения между ними
+        if (inotify_ >= 0) {
+            dir.watch = inotify_add_watch(inotify_, dirPath.c_str(), kWatchMask);
+        }
+#endif
+        scan(dirPath, dir);
+    }
+
+    order_ = std::move(order);
+    dirty_ = true;
+}
+
+void CompletionIndex::scan(const std::string &path, Directory &dir) {
+    dir.names.clear();
+    DIR *stream = opendir(path.c_str());
+    if (stream == nullptr) {
+        return;
+    }
+    const int fd = dirfd(stream);
+    struct stat st {};
+    if (fstat(fd, &st) == 0) {
+        dir.mtime = modificationTime(st);
+    }
+    while (const dirent *entry = readdir(stream)) {
+        if (entry->d_name[0] != '.' && isExecutable(fd, entry->d_name, entry->d_type)) {
+            dir.names.emplace_back(entry->d_name);
+        }
+    }
+    closedir(stream);
+    std::sort(dir.names.begin(), dir.names.end());
+}
+
+void CompletionIndex::applyChanges() {
+#if defined(__linux__)
+    if (inotify_ >= 0) {
+        alignas(inotify_event) char buffer[16 * 1024];
+        while (true) {
+            const ssize_t n = read(inotify_, buffer, sizeof(buffer));
+            if (n <= 0) {
+                break;
+            }
+            for (ssize_t offset = 0; offset < n;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                if ((event->mask & IN_Q_OVERFLOW) != 0) {
+                    for (auto &[dirPath, dir] : dirs_) {
+                        scan(dirPath, dir);
+                    }
+                    dirty_ = true;
+                    continue;
+                }
+                // Несколько элементов PATH могут вести в одну директорию (/bin и /usr/bin
+                // при merged /usr, ссылки): inotify даёт им один watch, и событие
+                // относится ко всем
+                if ((event->mask & IN_MOVE_SELF) != 0) {
+                    // Watch переименованной директории следует за ней: снимаем его сами
+                    inotify_rm_watch(inotify_, event->wd);
+                }
+                for (auto &[dirPath, dir] : dirs_) {
+                    if (dir.watch == event->wd) {
+                        applyEvent(dirPath, dir, event->mask,
+                                   event->len != 0 ? event->name : "");
+                        dirty_ = true;
+                    }
+                }
+            }
+        }
+
+        // Директория не существовала при setPath или была удалена/переименована:
+        // пробуем поставить watch заново и, если получилось, сканируем её
+        for (auto &[dirPath, dir] : dirs_) {
+            if (dir.watch < 0) {
+                dir.watch = inotify_add_watch(inotify_, dirPath.c_str(), kWatchMask);
+                if (dir.watch >= 0) {
+                    scan(dirPath, dir);
+                    dirty_ = true;
+                }
+            }
+        }
+        return;
+    }
+#endif
+    // Без inotify: пересканировать директории, у которых изменилось mtime
+    for (auto &[dirPath, dir] : dirs_) {
+        struct stat st {};
+        if (stat(dirPath.c_str(), &st) == 0 && !sameTime(modificationTime(st), dir.mtime)) {
+            scan(dirPath, dir);
+            dirty_ = true;
+        }
+    }
+}
+
+#if defined(__linux__)
+void CompletionIndex::applyEvent(const std::string &path,
+                                 Directory &dir,
+                                 std::uint32_t mask,
+                                 std::string_view name) {
+    if ((mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) != 0) {
+        dir.watch = -1;
+        dir.names.clear();
+        return;
+    }
+    if (name.empty() || name[0] == '.') {
+        return;
+    }
+    const std::string entry(name);
+    if ((mask & (IN_DELETE | IN_MOVED_FROM)) != 0) {
+        eraseSorted(dir.names, entry);
+        return;
+    }
+    const int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    const bool executable = fd >= 0 && isExecutable(fd, entry.c_str(), DT_UNKNOWN);
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (executable) {
+        insertSorted(dir.names, entry);
+    } else {
+        eraseSorted(dir.names, entry);
+    }
+}
+#endif
+
+void CompletionIndex::rebuild() {
+    merged_ = builtins_;
+    for (const std::string &dirPath : order_) {
+        const Directory &dir = dirs_[dirPath];
+        merged_.insert(merged_.end(), dir.names.begin(), dir.names.end());
+    }
+    std::sort(merged_.begin(), merged_.end());
+    merged_.erase(std::unique(merged_.begin(), merged_.end()), merged_.end());
+    dirty_ = false;
+}
+
+std::vector<std::string> CompletionIndex::complete(std::string_view prefix) {
+    applyChanges();
+    if (dirty_) {
+        rebuild();
+    }
+
+    std::vector<std::string> result;
+    for (auto it = std::lower_bound(merged_.begin(), merged_.end(), prefix);
+         it != merged_.end() && it->compare(0, prefix.size(), prefix) == 0; ++it) {
+        result.push_back(*it);
+    }
+    return result;
+}
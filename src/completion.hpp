@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Индекс имён команд для дополнения по Tab: builtins и исполняемые файлы из PATH.
+//
+// Имена хранятся в отсортированном массиве, запрос по префиксу — двоичный поиск.
+// Каждая директория PATH сканируется один раз; дальше на Linux изменения приходят
+// через inotify и применяются по одному имени, на других платформах директория
+// пересканируется, если изменилось её mtime. При смене PATH пересканируются только
+// новые директории. Директория PATH, которой нет (ещё не создана или удалена), снова
+// проверяется перед каждым запросом и подхватывается, когда появится.
+class CompletionIndex {
+public:
+    CompletionIndex();
+    ~CompletionIndex();
+
+    CompletionIndex(const CompletionIndex &) = delete;
+    CompletionIndex &operator=(const CompletionIndex &) = delete;
+
+    void setBuiltins(std::vector<std::string> names);
+
+    // Новое значение PATH (список директорий через ':')
+    void setPath(std::string_view path);
+
+    // Имена с данным префиксом в порядке сортировки, без повторов
+    std::vector<std::string> complete(std::string_view prefix);
+
+private:
+    struct Directory {
+        std::vector<std::string> names;  // отсортированы
+        int watch = -1;                  // дескриптор inotify watch
+        std::timespec mtime{};
+    };
+
+    void scan(const std::string &path, Directory &dir);
+    void applyChanges();
+    // Linux: одно событие inotify для директории path (name пусто у событий самой директории)
+    void applyEvent(const std::string &path,
+                    Directory &dir,
+                    std::uint32_t mask,
+                    std::string_view name);
+    void rebuild();
+
+    std::vector<std::string> builtins_;
+    std::vector<std::string> order_;  // директории PATH в порядке поиска
+    std::unordered_map<std::string, Directory> dirs_;
+    std::vector<std::string> merged_;
+    bool dirty_ = true;
+    int inotify_ = -1;
+};
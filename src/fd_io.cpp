@@ -0,0 +1,92 @@
+#include "fd_io.hpp"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+FdWriter::FdWriter(int fd, std::size_t capacity) : fd_(fd), buffer_(capacity) {}
+
+FdWriter::~FdWriter() {
+    flush();
+}
+
+void FdWriter::write(std::string_view data) {
+    if (data.size() > buffer_.size() - size_) {
+        flush();
+    }
+    // Крупные блоки идут в fd напрямую, минуя буфер
+    if (data.size() >= buffer_.size()) {
+        while (!data.empty()) {
+            const ssize_t n = ::write(fd_, data.data(), data.size());
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            data.remove_prefix(static_cast<std::size_t>(n));
+        }
+        return;
+    }
+    std::memcpy(buffer_.data() + size_, data.data(), data.size());
+    size_ += data.size();
+}
+
+bool FdWriter::flush() {
+    std::size_t done = 0;
+    while (done < size_) {
+        const ssize_t n = ::write(fd_, buffer_.data() + done, size_ - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            size_ = 0;
+            return false;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    size_ = 0;
+    return true;
+}
+
+FdReader::FdReader(int fd, FdWriter *tied, std::size_t capacity)
+    : fd_(fd), tied_(tied), buffer_(capacity) {}
+
+bool FdReader::fill() {
+    if (tied_ != nullptr) {
+        tied_->flush();
+    }
+    begin_ = end_ = 0;
+    while (true) {
+        const ssize_t n = ::read(fd_, buffer_.data(), buffer_.size());
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        end_ = static_cast<std::size_t>(n);
+        return true;
+    }
+}
+
+bool FdReader::readLine(std::string &line) {
+    line.clear();
+    while (true) {
+        const char *start = buffer_.data() + begin_;
+        const auto *newline = static_cast<const char *>(std::memchr(start, '\n', end_ - begin_));
+        if (newline != nullptr) {
+            line.append(start, newline);
+            begin_ += static_cast<std::size_t>(newline - start) + 1;
+            return true;
+        }
+
+        // Неполная строка: забираем её в line и читаем следующий блок
+        line.append(start, end_ - begin_);
+        if (!fill()) {
+            // Последняя строка без завершающего '\n' тоже считается строкой
+            return !line.empty();
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Буферизованный ввод-вывод поверх файлового дескриптора, без iostream:
+// нет статической инициализации std::cin/std::cout и синхронизации со stdio.
+
+class FdWriter {
+public:
+    explicit FdWriter(int fd, std::size_t capacity = 64 * 1024);
+    ~FdWriter();
+
+    FdWriter(const FdWriter &) = delete;
+    FdWriter &operator=(const FdWriter &) = delete;
+
+    void write(std::string_view data);
+
+    // Записать буфер в fd; false при ошибке записи (кроме EINTR)
+    bool flush();
+
+private:
+    int fd_;
+    std::vector<char> buffer_;
+    std::size_t size_ = 0;
+};
+
+class FdReader {
+public:
+    // tied сбрасывается перед каждым блокирующим read (как std::cin.tie)
+    explicit FdReader(int fd, FdWriter *tied = nullptr, std::size_t capacity = 64 * 1024);
+
+    // Прочитать строку без '\n'; false — EOF или ошибка, и строка пуста
+    bool readLine(std::string &line);
+
+private:
+    // Прочитать следующий блок в пустой буфер
+    bool fill();
+
+    int fd_;
+    FdWriter *tied_;
+    std::vector<char> buffer_;
+    std::size_t begin_ = 0;
+    std::size_t end_ = 0;
+};
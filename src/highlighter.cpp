@@ -0,0 +1,133 @@
+#include "highlighter.hpp"
+
+#include <algorithm>
+
+namespace {
+
+enum class Mode { Normal, InSingleQuote, InDoubleQuote };
+
+bool isNameStart(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+}
+
+bool isNameChar(char c) {
+    return isNameStart(c) || (c >= '0' && c <= '9');
+}
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+}  // namespace
+
+void Highlighter::reset(std::string_view text) {
+    styles_.assign(text.size(), Style::Plain);
+    checkpoints_.assign(1, 0);
+    lastScanned_ = scan(text, 0, {});
+}
+
+void Highlighter::update(std::string_view text,
+                         std::size_t pos,
+                         std::size_t removed,
+                         std::size_t inserted) {
+    const auto at = styles_.begin() + static_cast<std::ptrdiff_t>(pos);
+    styles_.erase(at, at + static_cast<std::ptrdiff_t>(removed));
+    styles_.insert(styles_.begin() + static_cast<std::ptrdiff_t>(pos), inserted, Style::Plain);
+
+    // Точки не правее pos остаются в силе, разбор начинается с последней из них.
+    // Точки правее удалённого участка сдвигаются и служат кандидатами на схождение.
+    const auto firstAfter = std::upper_bound(checkpoints_.begin(), checkpoints_.end(), pos);
+    std::vector<std::size_t> old;
+    for (auto it = std::upper_bound(firstAfter, checkpoints_.end(), pos + removed);
+         it != checkpoints_.end(); ++it) {
+        old.push_back(*it - removed + inserted);
+    }
+    checkpoints_.erase(firstAfter, checkpoints_.end());
+
+    const std::size_t start = checkpoints_.back();
+    const std::size_t stop = scan(text, start, old);
+    lastScanned_ = stop - start;
+
+    // Старые точки действительны, только если разбор сошёлся со старым до конца строки
+    if (stop < text.size()) {
+        for (const std::size_t point : old) {
+            if (point >= stop) {
+                checkpoints_.push_back(point);
+            }
+        }
+    }
+}
+
+const std::vector<Style> &Highlighter::styles() const {
+    return styles_;
+}
+
+std::size_t Highlighter::lastScanned() const {
+    return lastScanned_;
+}
+
+std::size_t Highlighter::scan(std::string_view text,
+                              std::size_t start,
+                              const std::vector<std::size_t> &old) {
+    Mode mode = Mode::Normal;
+    bool inName = false;
+    auto candidate = old.begin();
+
+    for (std::size_t i = start; i < text.size(); ++i) {
+        const bool boundary = i > start && mode == Mode::Normal && !inName &&
+                              (isSpace(text[i - 1]) || text[i - 1] == '|');
+        if (boundary) {
+            while (candidate != old.end() && *candidate < i) {
+                ++candidate;
+            }
+            if (candidate != old.end() && *candidate == i) {
+                return i;  // дальше разбор совпадает со старым
+            }
+            checkpoints_.push_back(i);
+        }
+
+        const char c = text[i];
+        const bool nameFollows = i + 1 < text.size() && isNameStart(text[i + 1]);
+        Style style = Style::Plain;
+
+        if (inName && isNameChar(c)) {
+            styles_[i] = Style::Variable;
+            continue;
+        }
+        inName = false;
+
+        switch (mode) {
+            case Mode::Normal:
+                if (c == '\'') {
+                    mode = Mode::InSingleQuote;
+                    style = Style::SingleQuoted;
+                } else if (c == '"') {
+                    mode = Mode::InDoubleQuote;
+                    style = Style::DoubleQuoted;
+                } else if (c == '|') {
+                    style = Style::Pipe;
+                } else if (c == '$' && nameFollows) {
+                    inName = true;
+                    style = Style::Variable;
+                }
+                break;
+            case Mode::InSingleQuote:
+                style = Style::SingleQuoted;
+                if (c == '\'') {
+                    mode = Mode::Normal;
+                }
+                break;
+            case Mode::InDoubleQuote:
+                style = Style::DoubleQuoted;
+                if (c == '"') {
+                    mode = Mode::Normal;
+                } else if (c == '$' && nameFollows) {
+                    inName = true;
+                    style = Style::Variable;
+                }
+                break;
+        }
+        styles_[i] = style;
+    }
+    return text.size();
+}
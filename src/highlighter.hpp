@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Класс символа строки для подсветки — по тем же правилам, что и у Lexer
+// (раздел 8.2 архитектуры): кавычки, оператор | и подстановки $NAME.
+enum class Style : std::uint8_t {
+    Plain,
+    SingleQuoted,  // '...' вместе с кавычками
+    DoubleQuoted,  // "..." вместе с кавычками
+    Variable,      // $NAME вне кавычек и в "..."
+    Pipe,          // | вне кавычек
+};
+
+// Инкрементальная подсветка строки редактора.
+//
+// Автомат лексера (Normal / InSingleQuote / InDoubleQuote) запоминает контрольные
+// точки — границы токенов, где он в состоянии Normal (после пробела или |). Стиль
+// символов после такой точки зависит только от текста после неё. При правке
+// повторный разбор начинается с последней контрольной точки до места правки и
+// останавливается на первой старой контрольной точке после неё, поэтому работа
+// пропорциональна размеру правки и токена вокруг неё, а не длине строки.
+class Highlighter {
+public:
+    // Полный разбор text
+    void reset(std::string_view text);
+
+    // text — строка после правки: с позиции pos удалено removed байт и вставлено inserted
+    void update(std::string_view text, std::size_t pos, std::size_t removed, std::size_t inserted);
+
+    // Стиль каждого байта текущей строки
+    const std::vector<Style> &styles() const;
+
+    // Сколько байт разобрано при последнем reset/update
+    std::size_t lastScanned() const;
+
+private:
+    // Разбор с контрольной точки start до конца строки или до совпадения с одной из
+    // old (отсортированные позиции, где разбор заведомо сходится со старым)
+    std::size_t scan(std::string_view text, std::size_t start, const std::vector<std::size_t> &old);
+
+    std::vector<Style> styles_;
+    std::vector<std::size_t> checkpoints_;
+    std::size_t lastScanned_ = 0;
+};
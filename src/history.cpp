@@ -0,0 +1,513 @@
+#include "history.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+constexpr std::size_t kTrigram = 3;
+
+// Файл сегмента: заголовок, затем отсортированные триграммы (uint32), начала их
+// списков (uint32, на одно больше числа триграмм) и списки номеров записей внутри
+// сегмента (uint16, возрастают)
+constexpr char kSegmentMagic[8] = {'M', 'S', 'H', 'S', 'E', 'G', '1', '\0'};
+
+struct SegmentHeader {
+    char magic[8];
+    std::uint64_t device;  // журнал, по которому построен сегмент
+    std::uint64_t inode;
+    std::uint64_t begin;     // байты сегмента в журнале
+    std::uint64_t end;
+    std::uint64_t edgeHash;  // хеш первой и последней записи сегмента
+    std::uint32_t trigramCount;
+    std::uint32_t postingCount;
+};
+
+static_assert(History::kSegmentEntries <= 65536, "номер записи в сегменте хранится в uint16");
+
+std::uint32_t trigramKey(const char *p) {
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(p[0])) << 16 |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(p[1])) << 8 |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(p[2]));
+}
+
+int openLog(const std::string &path) {
+    return ::open(path.c_str(), O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+}
+
+std::uint64_t fnv1a(std::string_view text, std::uint64_t hash = 14695981039346656037ULL) {
+    for (const char c : text) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Дешёвая проверка, что сегмент построен по тем же байтам журнала: после усечения и
+// повторного заполнения файла границы сегмента могут совпасть, а записи — нет
+std::uint64_t edgeHash(std::string_view first, std::string_view last) {
+    return fnv1a(last, fnv1a(first) ^ 0x9E3779B97F4A7C15ULL);
+}
+
+std::string segmentPath(const std::string &dir, std::size_t segment) {
+    return dir + "/seg-" + std::to_string(segment);
+}
+
+bool readHeader(const char *data, std::size_t size, SegmentHeader &header) {
+    if (size < sizeof(SegmentHeader)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(SegmentHeader));
+    const std::size_t keysAndStarts = 2 * std::size_t{header.trigramCount} + 1;
+    const std::size_t expected = sizeof(SegmentHeader) + sizeof(std::uint32_t) * keysAndStarts +
+                                 sizeof(std::uint16_t) * header.postingCount;
+    return std::memcmp(header.magic, kSegmentMagic, sizeof(kSegmentMagic)) == 0 &&
+           size == expected;
+}
+
+// Файл сегмента по байтам журнала [begin, end) — ровно kSegmentEntries записей
+std::string buildSegment(const std::string &bytes, SegmentHeader header) {
+    std::vector<std::uint64_t> pairs;  // (триграмма << 16) | номер записи в сегменте
+    std::string_view first;
+    std::string_view last;
+    std::uint64_t id = 0;
+    for (std::size_t pos = 0; pos < bytes.size(); ++id) {
+        const std::size_t newline = bytes.find('\n', pos);
+        const std::string_view text(bytes.data() + pos, newline - pos);
+        if (id == 0) {
+            first = text;
+        }
+        last = text;
+        for (std::size_t i = 0; i + kTrigram <= text.size(); ++i) {
+            pairs.push_back(std::uint64_t{trigramKey(text.data() + i)} << 16 | id);
+        }
+        pos = newline + 1;
+    }
+    // Пары порождаются по возрастанию номера записи, поэтому достаточно устойчивой
+    // поразрядной сортировки по 24 битам триграммы: три прохода по байту
+    std::vector<std::uint64_t> sorted(pairs.size());
+    for (unsigned shift = 16; shift < 40; shift += 8) {
+        std::size_t offsets[257] = {};
+        for (const std::uint64_t pair : pairs) {
+            ++offsets[((pair >> shift) & 0xFF) + 1];
+        }
+        for (std::size_t i = 1; i < 257; ++i) {
+            offsets[i] += offsets[i - 1];
+        }
+        for (const std::uint64_t pair : pairs) {
+            sorted[offsets[(pair >> shift) & 0xFF]++] = pair;
+        }
+        pairs.swap(sorted);
+    }
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    std::vector<std::uint32_t> keys;
+    std::vector<std::uint32_t> starts;
+    std::vector<std::uint16_t> postings(pairs.size());
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+        const auto key = static_cast<std::uint32_t>(pairs[i] >> 16);
+        if (keys.empty() || keys.back() != key) {
+            keys.push_back(key);
+            starts.push_back(static_cast<std::uint32_t>(i));
+        }
+        postings[i] = static_cast<std::uint16_t>(pairs[i] & 0xFFFF);
+    }
+    starts.push_back(static_cast<std::uint32_t>(pairs.size()));
+
+    header.edgeHash = edgeHash(first, last);
+    header.trigramCount = static_cast<std::uint32_t>(keys.size());
+    header.postingCount = static_cast<std::uint32_t>(postings.size());
+
+    std::string file(sizeof(header), '\0');
+    std::memcpy(file.data(), &header, sizeof(header));
+    const auto append = [&file](const auto &values) {
+        file.append(reinterpret_cast<const char *>(values.data()),
+                    values.size() * sizeof(values[0]));
+    };
+    append(keys);
+    append(starts);
+    append(postings);
+    return file;
+}
+
+bool writeAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        const ssize_t n = write(fd, data.data(), data.size());
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+    return true;
+}
+
+}  // namespace
+
+History::History(std::string path) : path_(std::move(path)), indexDir_(path_ + ".idx") {}
+
+History::~History() {
+    reset();
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool History::open() {
+    // Журнал разбирается при первом обращении (size, search), а не при запуске
+    fd_ = openLog(path_);
+    return fd_ >= 0;
+}
+
+void History::add(std::string_view line) {
+    if (fd_ < 0) {
+        return;
+    }
+    std::string record;
+    record.reserve(line.size() + 1);
+    record.append(line);
+    record.push_back('\n');
+
+    // Одна запись O_APPEND: параллельные интерпретаторы не перемешивают строки
+    ssize_t n = 0;
+    do {
+        n = write(fd_, record.data(), record.size());
+    } while (n < 0 && errno == EINTR);
+}
+
+std::size_t History::size() {
+    refresh();
+    return starts_.size();
+}
+
+std::string_view History::entry(std::size_t index) const {
+    if (index >= starts_.size()) {
+        return {};
+    }
+    const std::uint64_t begin = starts_[index];
+    const std::uint64_t end = index + 1 < starts_.size() ? starts_[index + 1] : parsed_;
+    return {data_ + begin, static_cast<std::size_t>(end - begin - 1)};
+}
+
+void History::refresh() {
+    if (fd_ < 0) {
+        return;
+    }
+    struct stat st {};
+    if (fstat(fd_, &st) != 0) {
+        return;
+    }
+
+    // Файл по пути заменён другим (ротация): переоткрываем и читаем новый
+    struct stat current {};
+    if (::stat(path_.c_str(), &current) == 0 &&
+        (current.st_ino != st.st_ino || current.st_dev != st.st_dev)) {
+        const int fd = openLog(path_);
+        if (fd >= 0 && fstat(fd, &st) == 0) {
+            reset();
+            close(fd_);
+            fd_ = fd;
+        } else if (fd >= 0) {
+            close(fd);
+        }
+    }
+    device_ = static_cast<std::uint64_t>(st.st_dev);
+    inode_ = static_cast<std::uint64_t>(st.st_ino);
+
+    // Файл усечён: старое отображение за концом файла дало бы SIGBUS при чтении.
+    // Усечение с последующим дописыванием выдаёт себя тем, что на месте конца
+    // последней разобранной записи уже не '\n'.
+    const auto size = static_cast<std::size_t>(st.st_size);
+    if (size < parsed_ || (parsed_ > 0 && data_[parsed_ - 1] != '\n')) {
+        reset();
+    }
+    if (size <= mapped_) {
+        return;
+    }
+
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        return;
+    }
+    if (data_ != nullptr) {
+        munmap(const_cast<char *>(data_), mapped_);
+    }
+    data_ = static_cast<const char *>(mapping);
+    mapped_ = size;
+
+    // Разбираем только полные записи; хвост без '\n' ещё дописывается
+    std::size_t pos = parsed_;
+    while (pos < mapped_) {
+        const auto *newline =
+            static_cast<const char *>(std::memchr(data_ + pos, '\n', mapped_ - pos));
+        if (newline == nullptr) {
+            break;
+        }
+        starts_.push_back(pos);
+        pos = static_cast<std::size_t>(newline - data_) + 1;
+    }
+    parsed_ = pos;
+}
+
+void History::reset() {
+    stopBuilder();
+    for (const Segment &segment : segments_) {
+        if (segment.data != nullptr) {
+            munmap(const_cast<char *>(segment.data), segment.size);
+        }
+    }
+    segments_.clear();
+    probed_ = 0;
+    jobs_.clear();
+    built_.clear();
+
+    if (data_ != nullptr) {
+        munmap(const_cast<char *>(data_), mapped_);
+    }
+    data_ = nullptr;
+    mapped_ = 0;
+    starts_.clear();
+    parsed_ = 0;
+}
+
+void History::stopBuilder() {
+    if (builder_.joinable()) {
+        stopBuilder_ = true;
+        builder_.join();
+        stopBuilder_ = false;
+    }
+}
+
+bool History::loadSegment(std::size_t segment) {
+    const int fd = ::open(segmentPath(indexDir_, segment).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st {};
+    void *mapping = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        mapping = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    const auto *data = static_cast<const char *>(mapping);
+    const auto size = static_cast<std::size_t>(st.st_size);
+    const std::size_t first = segment * kSegmentEntries;
+    const std::size_t last = first + kSegmentEntries - 1;
+    const std::uint64_t end = last + 1 < starts_.size() ? starts_[last + 1] : parsed_;
+
+    SegmentHeader header{};
+    if (!readHeader(data, size, header) || header.device != device_ || header.inode != inode_ ||
+        header.begin != starts_[first] || header.end != end ||
+        header.edgeHash != edgeHash(entry(first), entry(last))) {
+        munmap(mapping, size);
+        return false;  // сегмент от другого содержимого журнала: будет построен заново
+    }
+    segments_[segment] = {data, size};
+    return true;
+}
+
+void History::updateIndex() {
+    const std::size_t full = starts_.size() / kSegmentEntries;
+    if (segments_.size() < full) {
+        segments_.resize(full);
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock(builtMutex_);
+        for (const std::size_t segment : built_) {
+            if (segment < full && segments_[segment].data == nullptr) {
+                loadSegment(segment);
+            }
+        }
+        built_.clear();
+    }
+
+    // Новые полные сегменты: сначала файлы на диске (их мог построить другой
+    // интерпретатор), остальные — построителю
+    for (; probed_ < full; ++probed_) {
+        if (!loadSegment(probed_)) {
+            const std::size_t first = probed_ * kSegmentEntries;
+            const std::size_t next = first + kSegmentEntries;
+            jobs_.push_back({probed_, starts_[first],
+                             next < starts_.size() ? starts_[next] : parsed_});
+        }
+    }
+
+    if (builder_.joinable() && builderDone_) {
+        builder_.join();
+    }
+    if (builder_.joinable() || jobs_.empty()) {
+        return;
+    }
+
+    // Свежие сегменты первыми: Ctrl-R чаще находит недавние записи
+    std::reverse(jobs_.begin(), jobs_.end());
+    const int logFd = dup(fd_);
+    if (logFd < 0) {
+        return;
+    }
+    builderDone_ = false;
+    builder_ = std::thread(&History::buildSegments, this, logFd, device_, inode_, std::move(jobs_));
+    jobs_.clear();
+}
+
+void History::buildSegments(int logFd,
+                            std::uint64_t device,
+                            std::uint64_t inode,
+                            std::vector<SegmentJob> jobs) {
+    mkdir(indexDir_.c_str(), 0700);
+    SegmentHeader header{};
+    std::memcpy(header.magic, kSegmentMagic, sizeof(kSegmentMagic));
+    header.device = device;
+    header.inode = inode;
+
+    std::string bytes;
+    for (const SegmentJob &job : jobs) {
+        if (stopBuilder_.load(std::memory_order_relaxed)) {
+            break;
+        }
+        bytes.resize(static_cast<std::size_t>(job.end - job.begin));
+        if (pread(logFd, bytes.data(), bytes.size(), static_cast<off_t>(job.begin)) !=
+            static_cast<ssize_t>(bytes.size())) {
+            break;  // журнал усечён; refresh() заметит это и начнёт заново
+        }
+        header.begin = job.begin;
+        header.end = job.end;
+        const std::string file = buildSegment(bytes, header);
+
+        // Временный файл и rename: другие интерпретаторы видят либо целый сегмент,
+        // либо никакого
+        const std::string path = segmentPath(indexDir_, job.segment);
+        const std::string tmp = path + "." + std::to_string(getpid()) + ".tmp";
+        const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            break;  // каталог индекса недоступен: остаётся просмотр подряд
+        }
+        const bool written = writeAll(fd, file);
+        close(fd);
+        if (!written || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            unlink(tmp.c_str());
+            break;
+        }
+        const std::lock_guard<std::mutex> lock(builtMutex_);
+        built_.push_back(job.segment);
+    }
+    close(logFd);
+    builderDone_ = true;
+}
+
+bool History::indexComplete() {
+    refresh();
+    updateIndex();
+    return std::all_of(segments_.begin(), segments_.end(),
+                       [](const Segment &segment) { return segment.data != nullptr; });
+}
+
+std::optional<std::size_t> History::scan(std::string_view query,
+                                         std::size_t from,
+                                         std::size_t before) const {
+    for (std::size_t i = before; i-- > from;) {
+        if (entry(i).find(query) != std::string_view::npos) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::size_t> History::searchSegment(std::size_t segment,
+                                                  std::string_view query,
+                                                  std::size_t before) const {
+    const char *data = segments_[segment].data;
+    SegmentHeader header{};
+    std::memcpy(&header, data, sizeof(header));
+    const auto *keys = reinterpret_cast<const std::uint32_t *>(data + sizeof(header));
+    const std::uint32_t *starts = keys + header.trigramCount;
+    const auto *postings =
+        reinterpret_cast<const std::uint16_t *>(starts + header.trigramCount + 1);
+
+    struct List {
+        const std::uint16_t *begin;
+        const std::uint16_t *end;
+    };
+    std::vector<List> lists;
+    for (std::size_t i = 0; i + kTrigram <= query.size(); ++i) {
+        const std::uint32_t key = trigramKey(query.data() + i);
+        const std::uint32_t *it = std::lower_bound(keys, keys + header.trigramCount, key);
+        if (it == keys + header.trigramCount || *it != key) {
+            return std::nullopt;
+        }
+        const auto index = static_cast<std::size_t>(it - keys);
+        lists.push_back({postings + starts[index], postings + starts[index + 1]});
+    }
+    std::sort(lists.begin(), lists.end(), [](const List &a, const List &b) {
+        return a.end - a.begin < b.end - b.begin;
+    });
+
+    // Идём по самому короткому списку с конца, остальные проверяем двоичным поиском;
+    // совпадение всех триграмм ещё не означает вхождение подстроки — проверяем запись
+    const std::size_t first = segment * kSegmentEntries;
+    if (lists.empty()) {
+        // search() не передаёт сюда запросы короче триграммы, но без проверки
+        // lists.front() ниже — неопределённое поведение
+        return scan(query, first, before);
+    }
+    const auto limit = static_cast<std::uint32_t>(std::min(before - first, kSegmentEntries));
+    const List &shortest = lists.front();
+    const std::uint16_t *pos = std::lower_bound(shortest.begin, shortest.end, limit);
+    while (pos != shortest.begin) {
+        --pos;
+        const std::uint16_t id = *pos;
+        const bool inAll = std::all_of(lists.begin() + 1, lists.end(), [id](const List &list) {
+            return std::binary_search(list.begin, list.end, id);
+        });
+        if (inAll && entry(first + id).find(query) != std::string_view::npos) {
+            return first + id;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::size_t> History::search(std::string_view query, std::size_t before) {
+    refresh();
+    before = std::min(before, starts_.size());
+    if (query.size() < kTrigram) {
+        return scan(query, 0, before);
+    }
+
+    updateIndex();
+
+    // Записи после последнего полного сегмента — меньше kSegmentEntries
+    const std::size_t indexedEnd = segments_.size() * kSegmentEntries;
+    if (before > indexedEnd) {
+        if (const auto found = scan(query, indexedEnd, before)) {
+            return found;
+        }
+        before = indexedEnd;
+    }
+
+    // Сегмент, который ещё строится, просматривается подряд
+    for (std::size_t segment = (before + kSegmentEntries - 1) / kSegmentEntries; segment-- > 0;) {
+        const std::size_t first = segment * kSegmentEntries;
+        const auto found = segments_[segment].data != nullptr
+                               ? searchSegment(segment, query, before)
+                               : scan(query, first, before);
+        if (found) {
+            return found;
+        }
+        before = first;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// История команд: файл-журнал "строка\n", в который только дописывают.
+//
+// Несколько интерпретаторов пишут в один файл через O_APPEND: каждая запись — один
+// write(), файл никогда не переписывается целиком. Чтение — через mmap; записи других
+// процессов подхватываются при следующем обращении (по росту размера файла).
+//
+// Если файл усекли или подменили (ротация, `: > файл` из другого интерпретатора), это
+// замечается при следующем обращении: отображение, список записей и индекс строятся
+// заново по новому содержимому.
+//
+// Для поиска подстроки (Ctrl-R) используется триграммный индекс, разбитый на сегменты
+// по kSegmentEntries записей. Сегмент — неизменяемый файл в каталоге "<файл>.idx/"
+// рядом с журналом: для каждой триграммы — возрастающий список номеров записей
+// сегмента. Файлы общие для всех интерпретаторов и переживают перезапуск; недостающие
+// сегменты строит фоновый поток. Записи вне готовых сегментов (неполный последний
+// сегмент, сегменты в работе) просматриваются подряд.
+class History {
+public:
+    // Записей в одном сегменте индекса
+    static constexpr std::size_t kSegmentEntries = 65536;
+
+    explicit History(std::string path);
+    ~History();
+
+    History(const History &) = delete;
+    History &operator=(const History &) = delete;
+
+    // Открыть (создать) файл истории, не читая его; false — история недоступна
+    bool open();
+
+    // Дописать строку в конец файла
+    void add(std::string_view line);
+
+    // Число записей (с учётом дописанных другими процессами)
+    std::size_t size();
+
+    // Запись по номеру (пустая, если номера уже нет); string_view действителен до
+    // следующего вызова неконстантного метода
+    std::string_view entry(std::size_t index) const;
+
+    // Самая свежая запись с номером < before, содержащая query
+    std::optional<std::size_t> search(std::string_view query, std::size_t before);
+
+    // Все полные сегменты индекса готовы и загружены (построение идёт в фоне)
+    bool indexComplete();
+
+private:
+    // Сегмент индекса, отображённый из файла
+    struct Segment {
+        const char *data = nullptr;
+        std::size_t size = 0;
+    };
+
+    // Задание фоновому построителю: сегмент и его байты в журнале
+    struct SegmentJob {
+        std::size_t segment;
+        std::uint64_t begin;
+        std::uint64_t end;
+    };
+
+    // Отобразить файл заново, если он вырос, и дополнить список записей
+    void refresh();
+    // Забыть отображение, записи и индекс (файл усечён или подменён)
+    void reset();
+
+    // Загрузить сегменты, готовые на диске, и отдать недостающие построителю
+    void updateIndex();
+    bool loadSegment(std::size_t segment);
+    void stopBuilder();
+    // Тело фонового потока: построить сегменты jobs и положить их файлы в indexDir_
+    void buildSegments(int logFd, std::uint64_t device, std::uint64_t inode,
+                       std::vector<SegmentJob> jobs);
+
+    std::optional<std::size_t> searchSegment(std::size_t segment,
+                                             std::string_view query,
+                                             std::size_t before) const;
+    // Просмотр записей [from, before) подряд, от новых к старым
+    std::optional<std::size_t> scan(std::string_view query,
+                                    std::size_t from,
+                                    std::size_t before) const;
+
+    std::string path_;
+    int fd_ = -1;
+    const char *data_ = nullptr;
+    std::size_t mapped_ = 0;
+    std::vector<std::uint64_t> starts_;  // начало каждой записи в файле
+    std::size_t parsed_ = 0;             // байт файла, разобранных на записи
+    std::uint64_t device_ = 0;           // st_dev и st_ino журнала: сегменты чужого
+    std::uint64_t inode_ = 0;            // файла с тем же путём не подходят
+
+    std::string indexDir_;
+    std::vector<Segment> segments_;  // по номеру сегмента; data == nullptr — не готов
+    std::size_t probed_ = 0;         // сегментов, для которых уже искали файл
+    std::vector<SegmentJob> jobs_;   // ждут запуска построителя
+
+    std::thread builder_;
+    std::atomic<bool> builderDone_{false};
+    std::atomic<bool> stopBuilder_{false};
+    std::mutex builtMutex_;
+    std::vector<std::size_t> built_;  // готовые у построителя, ещё не загруженные
+};
@@ -0,0 +1,67 @@
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+std::size_t LatencyHistogram::indexOf(std::uint64_t value) noexcept {
+    if (value < kSubBucketCount) {
+        return static_cast<std::size_t>(value);
+    }
+    // magnitude >= kSubBucketBits: номер старшего бита значения
+    const unsigned magnitude = 63U - static_cast<unsigned>(__builtin_clzll(value));
+    const unsigned shift = magnitude - kSubBucketBits + 1;
+    const std::uint64_t top = value >> shift;  // в диапазоне [kSubBucketHalf, kSubBucketCount)
+    return static_cast<std::size_t>(kSubBucketCount +
+                                    (magnitude - kSubBucketBits) * kSubBucketHalf +
+                                    (top - kSubBucketHalf));
+}
+
+std::uint64_t LatencyHistogram::highestValueAt(std::size_t index) noexcept {
+    if (index < kSubBucketCount) {
+        return index;
+    }
+    const std::uint64_t offset = index - kSubBucketCount;
+    const std::uint64_t magnitude = kSubBucketBits + offset / kSubBucketHalf;
+    const std::uint64_t top = kSubBucketHalf + offset % kSubBucketHalf;
+    const std::uint64_t shift = magnitude - kSubBucketBits + 1;
+    // Для последнего диапазона (top + 1) << shift переполняется до 0, и результат
+    // корректно становится максимальным uint64_t.
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t ns) noexcept {
+    counts_[indexOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(1, std::memory_order_relaxed);
+
+    std::uint64_t seen = max_.load(std::memory_order_relaxed);
+    while (ns > seen && !max_.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {
+    }
+}
+
+std::uint64_t LatencyHistogram::count() const noexcept {
+    return total_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::max() const noexcept {
+    return max_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::percentile(double quantile) const noexcept {
+    const std::uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+
+    const double clamped = std::clamp(quantile, 0.0, 1.0);
+    const auto target = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(clamped * static_cast<double>(total))));
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(highestValueAt(i), max());
+        }
+    }
+    return max();
+}
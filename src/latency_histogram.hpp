@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Гистограмма задержек в стиле HDR: логарифмические диапазоны, каждый поделён
+// на 64 линейных поддиапазона, поэтому относительная погрешность значения не
+// превышает 1/64 (~1.6%). Запись — несколько relaxed-атомиков, без блокировок.
+class LatencyHistogram {
+public:
+    // Записать одно значение (в наносекундах)
+    void record(std::uint64_t ns) noexcept;
+
+    std::uint64_t count() const noexcept;
+    std::uint64_t max() const noexcept;
+
+    // Верхняя граница диапазона, в который попадает доля quantile записей (quantile в [0, 1])
+    std::uint64_t percentile(double quantile) const noexcept;
+
+    // Номер диапазона, в который попадает value, и наибольшее значение диапазона index.
+    // Диапазоны нумеруются подряд от 0 и покрывают все значения uint64_t.
+    static std::size_t indexOf(std::uint64_t value) noexcept;
+    static std::uint64_t highestValueAt(std::size_t index) noexcept;
+
+private:
+    static constexpr unsigned kSubBucketBits = 7;
+    static constexpr std::uint64_t kSubBucketCount = 1ULL << kSubBucketBits;
+    static constexpr std::uint64_t kSubBucketHalf = kSubBucketCount / 2;
+    static constexpr std::size_t kBucketCount =
+        kSubBucketCount + (64 - kSubBucketBits) * kSubBucketHalf;
+
+    std::array<std::atomic<std::uint64_t>, kBucketCount> counts_{};
+    std::atomic<std::uint64_t> total_{0};
+    std::atomic<std::uint64_t> max_{0};
+};
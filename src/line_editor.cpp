@@ -0,0 +1,644 @@
+#include "line_editor.hpp"
+
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+namespace {
+
+// Сколько ждать продолжения escape-последовательности, прежде чем считать ESC клавишей
+constexpr int kEscapeTimeoutMs = 50;
+
+// Конец bracketed paste
+constexpr std::string_view kPasteEnd = "\x1b[201~";
+
+// Сколько вариантов дополнения показывать списком
+constexpr std::size_t kMaxListedCompletions = 200;
+
+constexpr unsigned char ctrl(char key) {
+    return static_cast<unsigned char>(key & 0x1f);
+}
+
+bool isContinuationByte(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+// Ширина в колонках терминала: по одной на символ UTF-8
+std::size_t columns(std::string_view text) {
+    return static_cast<std::size_t>(
+        std::count_if(text.begin(), text.end(), [](char c) { return !isContinuationByte(c); }));
+}
+
+const char *styleCode(Style style) {
+    switch (style) {
+        case Style::Plain:
+            return "\x1b[0m";
+        case Style::SingleQuoted:
+            return "\x1b[0;32m";
+        case Style::DoubleQuoted:
+            return "\x1b[0;33m";
+        case Style::Variable:
+            return "\x1b[0;36m";
+        case Style::Pipe:
+            return "\x1b[0;1;35m";
+    }
+    return "\x1b[0m";
+}
+
+}  // namespace
+
+LineEditor::LineEditor(int inFd, int outFd, FdWriter *tied) : in_(inFd), out_(outFd), tied_(tied) {}
+
+LineEditor::~LineEditor() {
+    disableRaw();
+}
+
+bool LineEditor::supported(int inFd, int outFd) {
+    const char *term = getenv("TERM");
+    return isatty(inFd) != 0 && isatty(outFd) != 0 &&
+           (term == nullptr || std::strcmp(term, "dumb") != 0);
+}
+
+void LineEditor::setHistory(History *history) {
+    history_ = history;
+}
+
+void LineEditor::setBuiltins(std::vector<std::string> names) {
+    builtins_ = std::move(names);
+    if (completion_) {
+        completion_->setBuiltins(builtins_);
+    }
+}
+
+bool LineEditor::readLine(std::string_view prompt, std::string &line) {
+    if (!pasted_.empty()) {
+        line = std::move(pasted_.front());
+        pasted_.pop_front();
+        // Терминал в обычном режиме, эхо raw-режима вставка не получила. Строка уходит
+        // в буфер stdout вместе с выводом команд — одной записью, без отдельного write
+        std::string echo;
+        echo.reserve(prompt.size() + line.size() + 1);
+        echo.append(prompt).append(line).push_back('\n');
+        if (tied_ != nullptr) {
+            tied_->write(echo);
+        } else {
+            write(echo);
+        }
+        return true;
+    }
+    if (!enableRaw()) {
+        return false;
+    }
+
+    prompt_ = prompt;
+    setText(std::move(pasteTail_));
+    pasteTail_.clear();
+    historyIndex_ = kAfterHistory;
+    draft_.clear();
+    searching_ = false;
+    refresh();
+
+    while (true) {
+        if (pendingPos_ >= pending_.size() && !ensureInput(1, true)) {
+            disableRaw();
+            return false;
+        }
+
+        // Обрабатываем всё, что уже прочитано, и только потом перерисовываем
+        Result result = Result::Continue;
+        while (result == Result::Continue && pendingPos_ < pending_.size()) {
+            result = processKey();
+        }
+
+        if (result == Result::Eof) {
+            disableRaw();
+            return false;
+        }
+        if (result == Result::Accept) {
+            cursor_ = text_.size();
+            refresh();
+            write("\r\n");
+            disableRaw();
+            line = text_;
+            return true;
+        }
+        refresh();
+    }
+}
+
+bool LineEditor::enableRaw() {
+    if (tcgetattr(in_, &original_) != 0) {
+        return false;
+    }
+    termios raw = original_;
+    raw.c_iflag &= ~static_cast<tcflag_t>(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+    raw.c_oflag &= ~static_cast<tcflag_t>(OPOST);
+    raw.c_cflag |= CS8;
+    raw.c_lflag &= ~static_cast<tcflag_t>(ECHO | ICANON | IEXTEN | ISIG);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    // TCSADRAIN, а не TCSAFLUSH: ввод, набранный заранее, не должен теряться
+    if (tcsetattr(in_, TCSADRAIN, &raw) != 0) {
+        return false;
+    }
+    raw_ = true;
+    write("\x1b[?2004h");  // включить bracketed paste
+    return true;
+}
+
+void LineEditor::disableRaw() {
+    if (raw_) {
+        write("\x1b[?2004l");
+        tcsetattr(in_, TCSADRAIN, &original_);
+        raw_ = false;
+    }
+}
+
+bool LineEditor::ensureInput(std::size_t count, bool wait) {
+    while (pending_.size() - pendingPos_ < count) {
+        if (!wait) {
+            pollfd pfd{in_, POLLIN, 0};
+            if (poll(&pfd, 1, kEscapeTimeoutMs) <= 0) {
+                return false;
+            }
+        }
+        char buffer[4096];
+        const ssize_t n = ::read(in_, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        if (pendingPos_ > 0) {
+            pending_.erase(0, pendingPos_);
+            pendingPos_ = 0;
+        }
+        pending_.append(buffer, static_cast<std::size_t>(n));
+    }
+    return true;
+}
+
+LineEditor::Result LineEditor::processKey() {
+    const auto key = static_cast<unsigned char>(pending_[pendingPos_++]);
+    if (searching_) {
+        return processSearchKey(key);
+    }
+
+    switch (key) {
+        case '\r':
+        case '\n':
+            return Result::Accept;
+        case ctrl('A'):
+            cursor_ = 0;
+            break;
+        case ctrl('E'):
+            cursor_ = text_.size();
+            break;
+        case ctrl('B'):
+            cursor_ = previousChar(cursor_);
+            break;
+        case ctrl('F'):
+            cursor_ = nextChar(cursor_);
+            break;
+        case ctrl('C'):
+            write("^C\r\n");
+            setText({});
+            historyIndex_ = kAfterHistory;
+            break;
+        case ctrl('D'):
+            if (text_.empty()) {
+                return Result::Eof;
+            }
+            erase(cursor_, nextChar(cursor_) - cursor_);
+            break;
+        case ctrl('H'):
+        case 127:
+            if (cursor_ > 0) {
+                const std::size_t start = previousChar(cursor_);
+                erase(start, cursor_ - start);
+            }
+            break;
+        case '\t':
+            complete();
+            break;
+        case ctrl('K'):
+            erase(cursor_, text_.size() - cursor_);
+            break;
+        case ctrl('L'):
+            write("\x1b[H\x1b[2J");
+            break;
+        case ctrl('N'):
+            historyMove(1);
+            break;
+        case ctrl('P'):
+            historyMove(-1);
+            break;
+        case ctrl('R'):
+            startSearch();
+            break;
+        case ctrl('U'):
+            erase(0, cursor_);
+            break;
+        case ctrl('W'): {
+            std::size_t start = cursor_;
+            while (start > 0 && text_[start - 1] == ' ') {
+                --start;
+            }
+            while (start > 0 && text_[start - 1] != ' ') {
+                --start;
+            }
+            erase(start, cursor_ - start);
+            break;
+        }
+        case 27:
+            return processEscape();
+        default:
+            if (key >= 32) {
+                // Вставляем сразу всю серию печатных байт: вставка большого текста —
+                // одна правка строки и один повторный разбор подсветки
+                const std::size_t start = pendingPos_ - 1;
+                while (pendingPos_ < pending_.size() &&
+                       static_cast<unsigned char>(pending_[pendingPos_]) >= 32 &&
+                       pending_[pendingPos_] != 127) {
+                    ++pendingPos_;
+                }
+                insert(std::string_view(pending_).substr(start, pendingPos_ - start));
+            }
+            break;
+    }
+    return Result::Continue;
+}
+
+LineEditor::Result LineEditor::processEscape() {
+    if (!ensureInput(1, false)) {
+        return Result::Continue;  // одиночный ESC
+    }
+    const char kind = pending_[pendingPos_];
+    if (kind != '[' && kind != 'O') {
+        return Result::Continue;
+    }
+    ++pendingPos_;
+
+    // CSI: ESC [ параметры финальный-байт; SS3: ESC O финальный-байт
+    std::string params;
+    char final = 0;
+    while (ensureInput(1, false)) {
+        const char c = pending_[pendingPos_++];
+        if (kind == '[' && ((c >= '0' && c <= '9') || c == ';')) {
+            params.push_back(c);
+            continue;
+        }
+        final = c;
+        break;
+    }
+
+    switch (final) {
+        case 'A':
+            historyMove(-1);
+            break;
+        case 'B':
+            historyMove(1);
+            break;
+        case 'C':
+            cursor_ = nextChar(cursor_);
+            break;
+        case 'D':
+            cursor_ = previousChar(cursor_);
+            break;
+        case 'H':
+            cursor_ = 0;
+            break;
+        case 'F':
+            cursor_ = text_.size();
+            break;
+        case '~':
+            if (params == "1" || params == "7") {
+                cursor_ = 0;
+            } else if (params == "4" || params == "8") {
+                cursor_ = text_.size();
+            } else if (params == "3") {
+                erase(cursor_, nextChar(cursor_) - cursor_);
+            } else if (params == "200") {
+                return processPaste();
+            }
+            break;
+        default:
+            break;
+    }
+    return Result::Continue;
+}
+
+LineEditor::Result LineEditor::processSearchKey(unsigned char key) {
+    switch (key) {
+        case ctrl('R'):
+            searchStep(match_ ? *match_ : history_->size());
+            return Result::Continue;
+        case ctrl('H'):
+        case 127:
+            while (!query_.empty() && isContinuationByte(query_.back())) {
+                query_.pop_back();
+            }
+            if (!query_.empty()) {
+                query_.pop_back();
+            }
+            searchStep(history_->size());
+            return Result::Continue;
+        case ctrl('G'):
+        case ctrl('C'):
+            finishSearch(false);
+            return Result::Continue;
+        case '\r':
+        case '\n':
+            finishSearch(true);
+            return Result::Accept;
+        default:
+            if (key >= 32 && key != 127) {
+                query_.push_back(static_cast<char>(key));
+                // Текущее совпадение может подходить и под удлинённый запрос
+                searchStep(match_ ? *match_ + 1 : history_->size());
+                return Result::Continue;
+            }
+            // Любая другая клавиша принимает найденную строку и обрабатывается как обычно
+            finishSearch(true);
+            --pendingPos_;
+            return Result::Continue;
+    }
+}
+
+LineEditor::Result LineEditor::processPaste() {
+    // Собираем вставку до \e[201~; хвост короче маркера оставляем в pending_,
+    // маркер может прийти разрезанным между двумя read
+    std::string body;
+    while (true) {
+        const std::size_t end = pending_.find(kPasteEnd, pendingPos_);
+        if (end != std::string::npos) {
+            body.append(pending_, pendingPos_, end - pendingPos_);
+            pendingPos_ = end + kPasteEnd.size();
+            break;
+        }
+        const std::size_t available = pending_.size() - pendingPos_;
+        const std::size_t keep = std::min(available, kPasteEnd.size() - 1);
+        body.append(pending_, pendingPos_, available - keep);
+        pendingPos_ += available - keep;
+        if (!ensureInput(keep + 1, true)) {
+            body.append(pending_, pendingPos_, std::string::npos);
+            pendingPos_ = pending_.size();
+            break;
+        }
+    }
+
+    // Терминалы передают перевод строки как \r, \n или \r\n; прочие управляющие
+    // символы, кроме табуляции, отбрасываются
+    std::vector<std::string> lines(1, text_.substr(0, cursor_));
+    for (std::size_t i = 0; i < body.size(); ++i) {
+        const char c = body[i];
+        if (c == '\r' || c == '\n') {
+            if (c == '\r' && i + 1 < body.size() && body[i + 1] == '\n') {
+                ++i;
+            }
+            lines.emplace_back();
+        } else if (static_cast<unsigned char>(c) >= 32 || c == '\t') {
+            lines.back().push_back(c);
+        }
+    }
+
+    if (lines.size() == 1) {
+        insert(std::string_view(lines.front()).substr(cursor_));
+        return Result::Continue;
+    }
+
+    // Текст правее курсора остаётся после вставки
+    pasteTail_ = std::move(lines.back()) + text_.substr(cursor_);
+    lines.pop_back();
+    setText(std::move(lines.front()));
+    pasted_.insert(pasted_.end(),
+                   std::make_move_iterator(lines.begin() + 1),
+                   std::make_move_iterator(lines.end()));
+    return Result::Accept;
+}
+
+void LineEditor::insert(std::string_view text) {
+    text_.insert(cursor_, text);
+    highlighter_.update(text_, cursor_, 0, text.size());
+    cursor_ += text.size();
+}
+
+void LineEditor::erase(std::size_t pos, std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+    text_.erase(pos, count);
+    highlighter_.update(text_, pos, count, 0);
+    if (cursor_ >= pos + count) {
+        cursor_ -= count;
+    } else if (cursor_ > pos) {
+        cursor_ = pos;
+    }
+}
+
+void LineEditor::setText(std::string text) {
+    text_ = std::move(text);
+    highlighter_.reset(text_);
+    cursor_ = text_.size();
+    offset_ = 0;
+}
+
+std::size_t LineEditor::previousChar(std::size_t pos) const {
+    if (pos == 0) {
+        return 0;
+    }
+    --pos;
+    while (pos > 0 && isContinuationByte(text_[pos])) {
+        --pos;
+    }
+    return pos;
+}
+
+std::size_t LineEditor::nextChar(std::size_t pos) const {
+    if (pos >= text_.size()) {
+        return text_.size();
+    }
+    ++pos;
+    while (pos < text_.size() && isContinuationByte(text_[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+void LineEditor::historyMove(int direction) {
+    if (history_ == nullptr) {
+        return;
+    }
+    const std::size_t size = history_->size();
+    historyIndex_ = std::min(historyIndex_, size);
+    if ((direction < 0 && historyIndex_ == 0) || (direction > 0 && historyIndex_ >= size)) {
+        return;
+    }
+    if (historyIndex_ >= size) {
+        draft_ = text_;
+    }
+    historyIndex_ = direction < 0 ? historyIndex_ - 1 : historyIndex_ + 1;
+    setText(historyIndex_ >= size ? draft_ : std::string(history_->entry(historyIndex_)));
+}
+
+void LineEditor::startSearch() {
+    if (history_ == nullptr) {
+        return;
+    }
+    searching_ = true;
+    searchFailed_ = false;
+    query_.clear();
+    match_.reset();
+    beforeSearch_ = text_;
+}
+
+void LineEditor::searchStep(std::size_t before) {
+    const auto found = history_->search(query_, before);
+    searchFailed_ = !found;
+    if (found) {
+        match_ = found;
+    }
+}
+
+void LineEditor::finishSearch(bool accept) {
+    searching_ = false;
+    if (accept && match_) {
+        historyIndex_ = *match_;
+        setText(std::string(history_->entry(*match_)));
+    } else {
+        setText(beforeSearch_);
+    }
+}
+
+void LineEditor::complete() {
+    // Дополняется только имя команды — первое слово строки
+    const std::size_t wordStart = std::min(text_.find_first_not_of(' '), text_.size());
+    if (cursor_ < wordStart || text_.find(' ', wordStart) < cursor_) {
+        return;
+    }
+    const std::string prefix = text_.substr(wordStart, cursor_ - wordStart);
+
+    if (!completion_) {
+        completion_ = std::make_unique<CompletionIndex>();
+        completion_->setBuiltins(builtins_);
+        const char *path = getenv("PATH");
+        completion_->setPath(path != nullptr ? path : "");
+    }
+    const std::vector<std::string> matches = completion_->complete(prefix);
+    if (matches.empty()) {
+        write("\a");
+        return;
+    }
+
+    std::string_view common = matches.front();
+    for (const std::string &match : matches) {
+        std::size_t n = 0;
+        while (n < common.size() && n < match.size() && common[n] == match[n]) {
+            ++n;
+        }
+        common = common.substr(0, n);
+    }
+
+    if (matches.size() == 1) {
+        insert(common.substr(prefix.size()));
+        if (cursor_ == text_.size()) {
+            insert(" ");
+        }
+    } else if (common.size() > prefix.size()) {
+        insert(common.substr(prefix.size()));
+    } else {
+        std::string list = "\r\n";
+        for (std::size_t i = 0; i < matches.size() && i < kMaxListedCompletions; ++i) {
+            list += matches[i];
+            list += "  ";
+        }
+        if (matches.size() > kMaxListedCompletions) {
+            list += "...";
+        }
+        list += "\r\n";
+        write(list);
+    }
+}
+
+void LineEditor::refresh() {
+    winsize size{};
+    const std::size_t width =
+        ioctl(out_, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 ? size.ws_col : 80;
+
+    std::string left = prompt_;
+    std::string_view shown = text_;
+    std::size_t cursor = cursor_;
+    if (searching_) {
+        left = (searchFailed_ ? "(failed reverse-i-search)`" : "(reverse-i-search)`") + query_ +
+               "': ";
+        shown = match_ ? history_->entry(*match_) : std::string_view(beforeSearch_);
+        cursor = std::min(shown.find(query_), shown.size());
+        offset_ = 0;
+    }
+
+    const std::size_t leftWidth = columns(left);
+    const std::size_t available = width > leftWidth + 1 ? width - leftWidth - 1 : 1;
+
+    // Горизонтальная прокрутка: курсор всегда внутри видимого окна
+    if (cursor < offset_) {
+        offset_ = cursor;
+    }
+    std::size_t cursorColumn = columns(shown.substr(offset_, cursor - offset_));
+    while (cursorColumn > available) {
+        ++offset_;
+        while (offset_ < shown.size() && isContinuationByte(shown[offset_])) {
+            ++offset_;
+        }
+        --cursorColumn;
+    }
+    std::size_t end = offset_;
+    for (std::size_t used = 0; end < shown.size() && used < available; ++used) {
+        ++end;
+        while (end < shown.size() && isContinuationByte(shown[end])) {
+            ++end;
+        }
+    }
+
+    std::string frame = "\r";
+    frame += left;
+    const std::vector<Style> &styles = highlighter_.styles();
+    Style current = Style::Plain;
+    for (std::size_t i = offset_; i < end; ++i) {
+        const Style style = searching_ ? Style::Plain : styles[i];
+        if (style != current) {
+            frame += styleCode(style);
+            current = style;
+        }
+        frame.push_back(shown[i]);
+    }
+    frame += "\x1b[0m\x1b[K\r";
+    const std::size_t column = leftWidth + cursorColumn;
+    if (column > 0) {
+        frame += "\x1b[" + std::to_string(column) + "C";
+    }
+    write(frame);
+}
+
+void LineEditor::write(std::string_view data) {
+    if (tied_ != nullptr) {
+        tied_->flush();
+    }
+    while (!data.empty()) {
+        const ssize_t n = ::write(out_, data.data(), data.size());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <termios.h>
+
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "completion.hpp"
+#include "fd_io.hpp"
+#include "highlighter.hpp"
+#include "history.hpp"
+
+// Редактор строки для интерактивного режима: терминал в raw-режиме, без readline.
+//
+// Клавиши: стрелки, Home/End, Backspace/Delete, Ctrl-A/E/B/F/K/U/W/L, Ctrl-C (сброс
+// строки), Ctrl-D (EOF на пустой строке), Up/Down и Ctrl-R (история), Tab (дополнение
+// имени команды). Строка подсвечивается по правилам Lexer через Highlighter.
+//
+// Все доступные байты ввода обрабатываются до перерисовки, а кадр перерисовки
+// собирается в буфер и выводится одним write. Длинная строка прокручивается по
+// горизонтали: выводится только видимое окно.
+//
+// Вставка из буфера обмена распознаётся по bracketed paste (\e[200~ ... \e[201~).
+// Если во вставке несколько строк, первая принимается сразу, а остальные выдаются
+// следующими вызовами readLine без приглашения, перерисовки и raw-режима — так же,
+// как строки из файла в пакетном режиме.
+class LineEditor {
+public:
+    // tied сбрасывается перед выводом редактора, чтобы не нарушить порядок вывода
+    LineEditor(int inFd, int outFd, FdWriter *tied);
+    ~LineEditor();
+
+    LineEditor(const LineEditor &) = delete;
+    LineEditor &operator=(const LineEditor &) = delete;
+
+    // Можно ли редактировать строку: оба fd — терминал, и терминал не "dumb"
+    static bool supported(int inFd, int outFd);
+
+    void setHistory(History *history);
+    void setBuiltins(std::vector<std::string> names);
+
+    // Прочитать строку; false — EOF (Ctrl-D на пустой строке) или ошибка ввода
+    bool readLine(std::string_view prompt, std::string &line);
+
+private:
+    enum class Result { Continue, Accept, Eof };
+
+    bool enableRaw();
+    void disableRaw();
+
+    // Дочитать ввод так, чтобы было хотя бы count необработанных байт;
+    // wait — ждать ли данных без ограничения по времени
+    bool ensureInput(std::size_t count, bool wait);
+
+    Result processKey();
+    Result processEscape();
+    Result processSearchKey(unsigned char key);
+    Result processPaste();
+
+    void insert(std::string_view text);
+    void erase(std::size_t pos, std::size_t count);
+    void setText(std::string text);
+    std::size_t previousChar(std::size_t pos) const;
+    std::size_t nextChar(std::size_t pos) const;
+
+    void historyMove(int direction);
+    void startSearch();
+    void searchStep(std::size_t before);
+    void finishSearch(bool accept);
+    void complete();
+
+    void refresh();
+    void write(std::string_view data);
+
+    int in_;
+    int out_;
+    FdWriter *tied_;
+    termios original_{};
+    bool raw_ = false;
+
+    std::string pending_;  // прочитанный, но не обработанный ввод
+    std::size_t pendingPos_ = 0;
+
+    std::deque<std::string> pasted_;  // полные строки вставки, ещё не выданные readLine
+    std::string pasteTail_;           // остаток вставки после последнего перевода строки
+
+    std::string prompt_;
+    std::string text_;
+    std::size_t cursor_ = 0;
+    std::size_t offset_ = 0;  // первый видимый байт при горизонтальной прокрутке
+    Highlighter highlighter_;
+
+    // historyIndex_ за последней записью; размер журнала узнаётся только при первом
+    // переходе по истории, чтобы не разбирать журнал до обращения к нему
+    static constexpr std::size_t kAfterHistory = std::numeric_limits<std::size_t>::max();
+
+    History *history_ = nullptr;
+    std::size_t historyIndex_ = kAfterHistory;
+    std::string draft_;  // строка, набранная до перехода по истории
+
+    bool searching_ = false;
+    bool searchFailed_ = false;
+    std::string query_;
+    std::optional<std::size_t> match_;
+    std::string beforeSearch_;  // строка на момент Ctrl-R, возвращается при отмене
+
+    std::vector<std::string> builtins_;
+    std::unique_ptr<CompletionIndex> completion_;
+};
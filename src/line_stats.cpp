@@ -0,0 +1,69 @@
+#include "line_stats.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace {
+
+const char *phaseName(LinePhase phase) {
+    switch (phase) {
+        case LinePhase::Parse:
+            return "parse";
+        case LinePhase::Spawn:
+            return "spawn";
+        case LinePhase::Run:
+            return "run";
+        case LinePhase::Reap:
+            return "reap";
+        case LinePhase::Line:
+            return "line";
+        case LinePhase::Count:
+            break;
+    }
+    return "?";
+}
+
+std::string formatDuration(std::uint64_t ns) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    if (ns < 1000) {
+        out << ns << "ns";
+    } else if (ns < 1000 * 1000) {
+        out << static_cast<double>(ns) / 1e3 << "us";
+    } else if (ns < 1000 * 1000 * 1000) {
+        out << static_cast<double>(ns) / 1e6 << "ms";
+    } else {
+        out << static_cast<double>(ns) / 1e9 << "s";
+    }
+    return out.str();
+}
+
+}  // namespace
+
+void LineStats::record(LinePhase phase, Clock::duration elapsed) noexcept {
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    phases_[static_cast<std::size_t>(phase)].record(ns > 0 ? static_cast<std::uint64_t>(ns) : 0);
+}
+
+void LineStats::report(std::ostream &out) const {
+    constexpr int kWidth = 10;
+    out << std::left << std::setw(kWidth) << "phase" << std::right << std::setw(kWidth) << "count"
+        << std::setw(kWidth) << "p50" << std::setw(kWidth) << "p90" << std::setw(kWidth) << "p99"
+        << std::setw(kWidth) << "p99.9" << std::setw(kWidth) << "max" << "\n";
+
+    for (std::size_t i = 0; i < phases_.size(); ++i) {
+        const LatencyHistogram &h = phases_[i];
+        if (h.count() == 0) {
+            continue;
+        }
+        out << std::left << std::setw(kWidth) << phaseName(static_cast<LinePhase>(i))
+            << std::right << std::setw(kWidth) << h.count() << std::setw(kWidth)
+            << formatDuration(h.percentile(0.50)) << std::setw(kWidth)
+            << formatDuration(h.percentile(0.90)) << std::setw(kWidth)
+            << formatDuration(h.percentile(0.99)) << std::setw(kWidth)
+            << formatDuration(h.percentile(0.999)) << std::setw(kWidth) << formatDuration(h.max())
+            << "\n";
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+
+#include "latency_histogram.hpp"
+
+// Фазы обработки одной строки, для каждой ведётся своя гистограмма задержек.
+enum class LinePhase {
+    Parse,  // Expander + Lexer + Parser
+    Spawn,  // запуск стадий пайплайна
+    Run,    // работа стадий
+    Reap,   // ожидание завершения (waitpid)
+    Line,   // строка целиком
+    Count,
+};
+
+class LineStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void record(LinePhase phase, Clock::duration elapsed) noexcept;
+
+    // Печать p50/p90/p99/p99.9/max по фазам, в которых есть замеры
+    void report(std::ostream &out) const;
+
+private:
+    std::array<LatencyHistogram, static_cast<std::size_t>(LinePhase::Count)> phases_;
+};
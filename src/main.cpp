@@ -1,6 +1,51 @@
+#include <unistd.h>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
 #include "shell.hpp"
 
-int main() {
-    Shell sh;
-    return sh.run();
-}
\ No newline at end of file
+int main(int argc, char **argv) {
+    ShellOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--stats") {
+            options.statsReport = true;
+        } else if (arg == "--profile" && i + 1 < argc) {
+            options.profilePath = argv[++i];
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            options.metricsPath = argv[++i];
+        } else if (arg == "--history" && i + 1 < argc) {
+            options.historyPath = argv[++i];
+        } else if (arg == "-c" && i + 1 < argc) {
+            options.command = argv[++i];
+        } else {
+            constexpr std::string_view kUsage =
+                "usage: mini_shell [--stats] [--profile FILE] [--metrics FILE]\n"
+                "                  [--history FILE] [-c LINE]\n";
+            const ssize_t written = write(STDERR_FILENO, kUsage.data(), kUsage.size());
+            (void)written;
+            return 2;
+        }
+    }
+
+    // Интерактивный режим по умолчанию ведёт историю в ~/.mini_shell_history
+    const char *home = getenv("HOME");
+    if (options.historyPath.empty() && !options.command && home != nullptr &&
+        isatty(STDIN_FILENO) != 0) {
+        options.historyPath = std::string(home) + "/.mini_shell_history";
+    }
+
+    Shell sh(options);
+    const int code = sh.run();
+
+#if defined(MINI_SHELL_SANITIZERS) || defined(MINI_SHELL_PGO)
+    // Обычный выход: LeakSanitizer проверяет утечки, а инструментированная PGO-сборка
+    // пишет профиль (.gcda / .profraw) в atexit; сборка с профилем повторяет её main
+    return code;
+#else
+    // Shell::run уже сбросил буферы вывода; деструкторы и atexit на выходе не нужны
+    _exit(code);
+#endif
+}
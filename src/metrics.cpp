@@ -0,0 +1,133 @@
+#include "metrics.hpp"
+
+#include <pthread.h>
+#include <signal.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+constexpr std::size_t kShardCount = 16;
+constexpr std::size_t kCounterCount = static_cast<std::size_t>(Counter::Count);
+constexpr std::size_t kExitCodeCount = 256;
+
+struct alignas(64) Shard {
+    std::array<std::atomic<std::uint64_t>, kCounterCount> counters{};
+    std::array<std::atomic<std::uint64_t>, kExitCodeCount> exitCodes{};
+};
+
+std::array<Shard, kShardCount> gShards;
+std::atomic<std::size_t> gNextShard{0};
+
+// Выгрузки по SIGUSR1 (поток sigwait), по команде metrics и при выходе пишут один и
+// тот же временный файл; без блокировки rename мог бы опубликовать смесь двух записей
+std::mutex gDumpMutex;
+
+Shard &localShard() noexcept {
+    thread_local Shard &shard =
+        gShards[gNextShard.fetch_add(1, std::memory_order_relaxed) % kShardCount];
+    return shard;
+}
+
+struct CounterInfo {
+    const char *name;
+    const char *help;
+};
+
+constexpr std::array<CounterInfo, kCounterCount> kCounters = {{
+    {"mini_shell_lines_total", "Non-empty lines executed."},
+    {"mini_shell_parse_errors_total", "Lines rejected by the lexer or parser."},
+    {"mini_shell_spawns_total", "Processes forked for pipeline stages."},
+    {"mini_shell_builtin_runs_total", "Builtin command invocations."},
+    {"mini_shell_external_runs_total", "External program invocations."},
+    {"mini_shell_path_cache_hits_total", "PATH lookups served from the cache."},
+    {"mini_shell_path_cache_misses_total", "PATH lookups that scanned directories."},
+}};
+
+std::uint64_t exitCodeCount(std::size_t code) noexcept {
+    std::uint64_t sum = 0;
+    for (const Shard &shard : gShards) {
+        sum += shard.exitCodes[code].load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+}  // namespace
+
+void Metrics::add(Counter counter, std::uint64_t delta) noexcept {
+    localShard()
+        .counters[static_cast<std::size_t>(counter)]
+        .fetch_add(delta, std::memory_order_relaxed);
+}
+
+void Metrics::recordExitCode(int code) noexcept {
+    const auto index = static_cast<std::size_t>(code) % kExitCodeCount;
+    localShard().exitCodes[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t Metrics::value(Counter counter) noexcept {
+    std::uint64_t sum = 0;
+    for (const Shard &shard : gShards) {
+        sum += shard.counters[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+void Metrics::writePrometheus(std::ostream &out) {
+    for (std::size_t i = 0; i < kCounterCount; ++i) {
+        const CounterInfo &info = kCounters[i];
+        out << "# HELP " << info.name << ' ' << info.help << '\n';
+        out << "# TYPE " << info.name << " counter\n";
+        out << info.name << ' ' << value(static_cast<Counter>(i)) << '\n';
+    }
+
+    out << "# HELP mini_shell_exit_codes_total Lines finished with the given exit code.\n";
+    out << "# TYPE mini_shell_exit_codes_total counter\n";
+    for (std::size_t code = 0; code < kExitCodeCount; ++code) {
+        const std::uint64_t count = exitCodeCount(code);
+        if (count != 0) {
+            out << "mini_shell_exit_codes_total{code=\"" << code << "\"} " << count << '\n';
+        }
+    }
+}
+
+bool Metrics::dumpToFile(const std::string &path) {
+    const std::lock_guard<std::mutex> lock(gDumpMutex);
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        writePrometheus(out);
+        if (!out.flush()) {
+            return false;
+        }
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+bool Metrics::dumpOnSignal(const std::string &path) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR1);
+    if (pthread_sigmask(SIG_BLOCK, &set, nullptr) != 0) {
+        return false;
+    }
+
+    std::thread([set, path]() {
+        while (true) {
+            int signo = 0;
+            if (sigwait(&set, &signo) == 0 && signo == SIGUSR1) {
+                dumpToFile(path);
+            }
+        }
+    }).detach();
+    return true;
+}
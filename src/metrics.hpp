@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Счётчики интерпретатора для мониторинга. Каждый счётчик разбит на шарды по
+// потокам (отдельные кэш-линии), увеличение — relaxed-атомик без разделяемой
+// кэш-линии между потоками; значение — сумма по шардам.
+enum class Counter {
+    Lines,            // исполненные непустые строки
+    ParseErrors,      // строки, отклонённые Lexer/Parser
+    Spawns,           // fork() для стадий пайплайна
+    BuiltinRuns,      // запуски builtins
+    ExternalRuns,     // запуски внешних программ
+    PathCacheHits,    // поиск в PATH, найденный в кэше
+    PathCacheMisses,  // поиск в PATH с обходом директорий
+    Count,
+};
+
+class Metrics {
+public:
+    static void add(Counter counter, std::uint64_t delta = 1) noexcept;
+
+    // Учесть код возврата строки (0..255)
+    static void recordExitCode(int code) noexcept;
+
+    static std::uint64_t value(Counter counter) noexcept;
+
+    // Текстовый формат Prometheus (exposition format 0.0.4)
+    static void writePrometheus(std::ostream &out);
+
+    // Записать во временный файл и переименовать в path, чтобы читатель
+    // (например, textfile collector node_exporter) не увидел файл наполовину.
+    // Параллельные вызовы (поток SIGUSR1 и основной поток) выполняются по очереди
+    static bool dumpToFile(const std::string &path);
+
+    // Выгружать метрики в path по SIGUSR1. Сигнал блокируется в вызывающем потоке
+    // (и в потоках, созданных после), его ожидает отдельный поток через sigwait.
+    static bool dumpOnSignal(const std::string &path);
+};
@@ -0,0 +1,225 @@
+#include "sampler.hpp"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/time.h>
+#if defined(__linux__)
+#include <ucontext.h>
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+namespace {
+
+constexpr std::size_t kMaxFrames = 48;
+constexpr std::size_t kMaxSamples = 1 << 14;
+
+struct Sample {
+    std::uintptr_t frames[kMaxFrames];
+    std::size_t depth;
+};
+
+constexpr bool kPlatformSupported =
+#if (defined(__linux__) || defined(__APPLE__)) && (defined(__x86_64__) || defined(__aarch64__))
+    true;
+#else
+    false;
+#endif
+
+// Состояние, доступное обработчику сигнала: выделяется в start(), до включения таймера
+Sample *gSamples = nullptr;
+std::atomic<std::size_t> gNext{0};
+std::uintptr_t gStackLow = 0;
+std::uintptr_t gStackHigh = 0;
+
+bool machineState(void *context, std::uintptr_t &pc, std::uintptr_t &fp, std::uintptr_t &sp) {
+    const auto *uc = static_cast<const ucontext_t *>(context);
+#if defined(__linux__) && defined(__x86_64__)
+    pc = static_cast<std::uintptr_t>(uc->uc_mcontext.gregs[REG_RIP]);
+    fp = static_cast<std::uintptr_t>(uc->uc_mcontext.gregs[REG_RBP]);
+    sp = static_cast<std::uintptr_t>(uc->uc_mcontext.gregs[REG_RSP]);
+    return true;
+#elif defined(__linux__) && defined(__aarch64__)
+    pc = uc->uc_mcontext.pc;
+    fp = uc->uc_mcontext.regs[29];
+    sp = uc->uc_mcontext.sp;
+    return true;
+#elif defined(__APPLE__) && defined(__x86_64__)
+    pc = uc->uc_mcontext->__ss.__rip;
+    fp = uc->uc_mcontext->__ss.__rbp;
+    sp = uc->uc_mcontext->__ss.__rsp;
+    return true;
+#elif defined(__APPLE__) && defined(__aarch64__)
+    pc = uc->uc_mcontext->__ss.__pc;
+    fp = uc->uc_mcontext->__ss.__fp;
+    sp = uc->uc_mcontext->__ss.__sp;
+    return true;
+#else
+    (void)uc;
+    (void)pc;
+    (void)fp;
+    (void)sp;
+    return false;
+#endif
+}
+
+// Обработчик SIGPROF: только чтение памяти стека и атомики (async-signal-safe)
+void onProfSignal(int /*signo*/, siginfo_t * /*info*/, void *context) {
+    std::uintptr_t pc = 0;
+    std::uintptr_t fp = 0;
+    std::uintptr_t sp = 0;
+    if (!machineState(context, pc, fp, sp)) {
+        return;
+    }
+
+    const std::size_t slot = gNext.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= kMaxSamples) {
+        return;
+    }
+
+    Sample &sample = gSamples[slot];
+    std::size_t depth = 0;
+    sample.frames[depth++] = pc;
+
+    // Запись кадра: fp[0] — fp вызывающего, fp[1] — адрес возврата.
+    // Проверяем, что fp лежит в стеке потока выше sp и цепочка растёт вверх.
+    const std::uintptr_t low = sp > gStackLow ? sp : gStackLow;
+    while (depth < kMaxFrames && fp >= low && fp + 2 * sizeof(std::uintptr_t) <= gStackHigh &&
+           fp % sizeof(std::uintptr_t) == 0) {
+        const auto *frame = reinterpret_cast<const std::uintptr_t *>(fp);
+        const std::uintptr_t ret = frame[1];
+        if (ret == 0) {
+            break;
+        }
+        sample.frames[depth++] = ret;
+        if (frame[0] <= fp) {
+            break;
+        }
+        fp = frame[0];
+    }
+    sample.depth = depth;
+}
+
+bool currentStackBounds(std::uintptr_t &low, std::uintptr_t &high) {
+#if defined(__linux__)
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) {
+        return false;
+    }
+    void *addr = nullptr;
+    std::size_t size = 0;
+    const int rc = pthread_attr_getstack(&attr, &addr, &size);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) {
+        return false;
+    }
+    low = reinterpret_cast<std::uintptr_t>(addr);
+    high = low + size;
+    return true;
+#elif defined(__APPLE__)
+    high = reinterpret_cast<std::uintptr_t>(pthread_get_stackaddr_np(pthread_self()));
+    low = high - pthread_get_stacksize_np(pthread_self());
+    return true;
+#else
+    (void)low;
+    (void)high;
+    return false;
+#endif
+}
+
+std::string symbolize(std::uintptr_t addr) {
+    Dl_info info{};
+    if (dladdr(reinterpret_cast<void *>(addr), &info) == 0) {
+        return "[unknown]";
+    }
+    if (info.dli_sname != nullptr) {
+        int status = 0;
+        std::unique_ptr<char, decltype(&std::free)> demangled(
+            abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), &std::free);
+        return status == 0 && demangled ? demangled.get() : info.dli_sname;
+    }
+    std::string module = info.dli_fname != nullptr ? info.dli_fname : "?";
+    const auto slash = module.rfind('/');
+    if (slash != std::string::npos) {
+        module.erase(0, slash + 1);
+    }
+    return "[" + module + "]";
+}
+
+}  // namespace
+
+bool Sampler::start(int hz) {
+    if (!kPlatformSupported || hz <= 0 || !currentStackBounds(gStackLow, gStackHigh)) {
+        return false;
+    }
+
+    if (gSamples == nullptr) {
+        gSamples = new Sample[kMaxSamples];
+    }
+    gNext.store(0, std::memory_order_relaxed);
+
+    struct sigaction action {};
+    action.sa_sigaction = onProfSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+        return false;
+    }
+
+    itimerval timer{};
+    timer.it_interval.tv_usec = 1000000 / hz;
+    timer.it_value = timer.it_interval;
+    return setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+}
+
+void Sampler::stop() {
+    itimerval timer{};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    signal(SIGPROF, SIG_IGN);
+}
+
+bool Sampler::writeFolded(const std::string &path) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    const std::size_t taken = gNext.load(std::memory_order_relaxed);
+    const std::size_t count = taken < kMaxSamples ? taken : kMaxSamples;
+
+    std::unordered_map<std::uintptr_t, std::string> names;
+    std::map<std::string, std::size_t> stacks;
+    for (std::size_t i = 0; i < count; ++i) {
+        const Sample &sample = gSamples[i];
+        std::string folded;
+        // От корня к листу; для адресов возврата ищем символ по ret - 1 (внутри call)
+        for (std::size_t d = sample.depth; d-- > 0;) {
+            const std::uintptr_t addr = d == 0 ? sample.frames[d] : sample.frames[d] - 1;
+            auto it = names.find(addr);
+            if (it == names.end()) {
+                it = names.emplace(addr, symbolize(addr)).first;
+            }
+            if (!folded.empty()) {
+                folded += ';';
+            }
+            folded += it->second;
+        }
+        ++stacks[folded];
+    }
+
+    for (const auto &[stack, hits] : stacks) {
+        out << stack << ' ' << hits << '\n';
+    }
+    if (taken > kMaxSamples) {
+        out << "[dropped] " << taken - kMaxSamples << '\n';
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+
+// Семплирующий профилировщик: по SIGPROF (таймер процессорного времени) снимает
+// стек прерванного кода, разматывая цепочку frame pointer'ов. Полные стеки
+// получаются только в сборке с -DENABLE_PROFILING=ON (-fno-omit-frame-pointer).
+//
+// Профилирует процесс интерпретатора, то есть код, исполняемый без fork.
+class Sampler {
+public:
+    // Запустить выборку с частотой hz; false, если платформа не поддерживается
+    static bool start(int hz);
+
+    // Остановить таймер; уже снятые стеки сохраняются
+    static void stop();
+
+    // Записать стеки в свёрнутом формате (flamegraph.pl, speedscope, inferno)
+    static bool writeFolded(const std::string &path);
+};
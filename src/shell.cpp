@@ -1,24 +1,166 @@
 #include "shell.hpp"
-#include <iostream>
+#include <unistd.h>
+#include <sstream>
 #include <string>
+#include <utility>
+
+#include "metrics.hpp"
+#include "sampler.hpp"
+
+namespace {
+
+// Простое число, чтобы частота выборки не совпадала с периодичными событиями в программе
+constexpr int kProfileHz = 997;
+
+}  // namespace
+
+Shell::Shell(ShellOptions options)
+    : options_(std::move(options)),
+      out_(STDOUT_FILENO),
+      err_(STDERR_FILENO, 4096),
+      in_(STDIN_FILENO, &out_) {}
 
 int Shell::run() {
+    if (!options_.profilePath.empty() && !Sampler::start(kProfileHz)) {
+        error("profiling is not supported on this platform");
+    }
+    if (!options_.metricsPath.empty() && !Metrics::dumpOnSignal(options_.metricsPath)) {
+        error("cannot install SIGUSR1 metrics handler");
+    }
+
+    if (!options_.historyPath.empty()) {
+        history_ = std::make_unique<History>(options_.historyPath);
+        if (!history_->open()) {
+            error("cannot open history file " + options_.historyPath);
+            history_.reset();
+        }
+    }
+
+    if (options_.command) {
+        const std::string &line = *options_.command;
+        return finish(line.empty() || line == "exit" ? 0 : processLine(line));
+    }
+
+    if (LineEditor::supported(STDIN_FILENO, STDOUT_FILENO)) {
+        editor_ = std::make_unique<LineEditor>(STDIN_FILENO, STDOUT_FILENO, &out_);
+        editor_->setHistory(history_.get());
+        editor_->setBuiltins({"exit", "history", "metrics", "stats"});
+    }
+
     std::string line;
 
     while (true) {
-        std::cout << "> " << std::flush;
+        if (!readLine(line)) {
+            out_.write("\n");
+            return finish(0);
+        }
 
-        if (!std::getline(std::cin, line)) {
-            std::cout << "\n";
-            return 0;
+        if (history_ && !line.empty()) {
+            history_->add(line);
         }
 
         if (line == "exit") {
-            return 0;
+            return finish(0);
         }
 
         if (!line.empty()) {
-            std::cout << "you typed: " << line << "\n";
+            processLine(line);
         }
     }
-}
\ No newline at end of file
+}
+
+bool Shell::readLine(std::string &line) {
+    if (editor_) {
+        return editor_->readLine("> ", line);
+    }
+    out_.write("> ");
+    return in_.readLine(line);
+}
+
+int Shell::processLine(const std::string &line) {
+    const auto start = LineStats::Clock::now();
+    const int status = runLine(line);
+    stats_.record(LinePhase::Line, LineStats::Clock::now() - start);
+    Metrics::add(Counter::Lines);
+    Metrics::recordExitCode(status);
+    return status;
+}
+
+int Shell::runLine(const std::string &line) {
+    if (line == "stats") {
+        std::ostringstream report;
+        stats_.report(report);
+        out_.write(report.str());
+        return 0;
+    }
+
+    if (line == "metrics") {
+        if (options_.metricsPath.empty()) {
+            std::ostringstream text;
+            Metrics::writePrometheus(text);
+            out_.write(text.str());
+        } else if (!Metrics::dumpToFile(options_.metricsPath)) {
+            error("cannot write metrics to " + options_.metricsPath);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (line == "history") {
+        printHistory();
+        return 0;
+    }
+
+    out_.write("you typed: ");
+    out_.write(line);
+    out_.write("\n");
+    return 0;
+}
+
+void Shell::printHistory() {
+    if (!history_) {
+        return;
+    }
+    const std::size_t count = history_->size();
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::string number = std::to_string(i + 1);
+        out_.write(std::string(number.size() < 5 ? 5 - number.size() : 0, ' '));
+        out_.write(number);
+        out_.write("  ");
+        out_.write(history_->entry(i));
+        out_.write("\n");
+    }
+}
+
+void Shell::error(std::string_view message) {
+    out_.flush();
+    err_.write("mini_shell: ");
+    err_.write(message);
+    err_.write("\n");
+    err_.flush();
+}
+
+int Shell::finish(int code) {
+    out_.flush();
+    if (options_.statsReport) {
+        std::ostringstream report;
+        stats_.report(report);
+        err_.write(report.str());
+        err_.flush();
+    }
+    if (!options_.profilePath.empty()) {
+        Sampler::stop();
+        if (!Sampler::writeFolded(options_.profilePath)) {
+            error("cannot write profile to " + options_.profilePath);
+        }
+    }
+    if (!options_.metricsPath.empty() && !Metrics::dumpToFile(options_.metricsPath)) {
+        error("cannot write metrics to " + options_.metricsPath);
+    }
+    // Дождаться фонового построителя индекса истории: _exit не ждёт потоков
+    if (editor_) {
+        editor_->setHistory(nullptr);
+    }
+    history_.reset();
+    return code;
+}
@@ -1,7 +1,64 @@
 #pragma once
 
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "fd_io.hpp"
+#include "history.hpp"
+#include "line_editor.hpp"
+#include "line_stats.hpp"
+
+struct ShellOptions {
+    // Печатать статистику задержек строк в stderr при выходе (пакетный режим)
+    bool statsReport = false;
+
+    // Файл для свёрнутых стеков семплирующего профилировщика (пусто — выключен)
+    std::string profilePath;
+
+    // Файл метрик в формате Prometheus: пишется по SIGUSR1, команде metrics и при выходе
+    std::string metricsPath;
+
+    // Файл истории команд (пусто — история не ведётся)
+    std::string historyPath;
+
+    // Строка для mini_shell -c: исполнить её и завершиться без REPL
+    std::optional<std::string> command;
+};
+
 class Shell {
 public:
+    explicit Shell(ShellOptions options = {});
+
     // Запуск интерпретатора
     int run();
-};
\ No newline at end of file
+
+private:
+    // Замер и учёт в метриках обработки одной непустой строки
+    int processLine(const std::string &line);
+
+    // Обработка одной непустой строки, возвращает код возврата строки
+    int runLine(const std::string &line);
+
+    // Печать истории в формате "номер  строка"
+    void printHistory();
+
+    // Чтение очередной строки: через редактор на терминале, иначе из stdin как есть
+    bool readLine(std::string &line);
+
+    // Сообщение "mini_shell: <message>" в stderr, после уже выведенного в stdout
+    void error(std::string_view message);
+
+    // Действия при завершении интерпретатора, возвращает code.
+    // Сбрасывает буферы вывода: после неё процесс может завершиться через _exit.
+    int finish(int code);
+
+    ShellOptions options_;
+    FdWriter out_;
+    FdWriter err_;
+    FdReader in_;
+    LineStats stats_;
+    std::unique_ptr<History> history_;
+    std::unique_ptr<LineEditor> editor_;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdio>
+
+// Проверки для тестов: в отличие от assert, работают и в Release (NDEBUG). Провал
+// печатает место и условие и делает код возврата теста ненулевым, но тест идёт дальше.
+namespace check {
+
+inline int &failures() {
+    static int count = 0;
+    return count;
+}
+
+inline bool expect(bool ok, const char *condition, const char *file, int line) {
+    if (!ok) {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+        ++failures();
+    }
+    return ok;
+}
+
+// Код возврата main
+inline int result() {
+    if (failures() != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures());
+        return 1;
+    }
+    return 0;
+}
+
+}  // namespace check
+
+#define CHECK(condition) check::expect(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
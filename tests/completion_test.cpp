@@ -0,0 +1,117 @@
+#include "check.hpp"
+#include "completion.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// CompletionIndex следит за директориями PATH: создание, удаление и повторное создание
+// исполняемого файла, директория, появившаяся после setPath, удалённая и созданная
+// заново директория, два элемента PATH, ведущие в одну директорию (ссылка).
+
+namespace {
+
+using Names = std::vector<std::string>;
+
+void createFile(const std::string &path, mode_t mode) {
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode);
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// На платформах без inotify изменения замечаются по mtime директории; пауза нужна,
+// чтобы mtime успел измениться на ФС с грубой отметкой времени
+void settle() {
+#if !defined(__linux__)
+    usleep(20 * 1000);
+#endif
+}
+
+bool expectNames(CompletionIndex &index, const char *prefix, const Names &expected,
+                 const char *stage) {
+    settle();
+    const Names actual = index.complete(prefix);
+    if (actual == expected) {
+        return true;
+    }
+    std::fprintf(stderr, "%s: complete(\"%s\") returned", stage, prefix);
+    for (const std::string &name : actual) {
+        std::fprintf(stderr, " %s", name.c_str());
+    }
+    std::fprintf(stderr, "\n");
+    return false;
+}
+
+}  // namespace
+
+int main() {
+    namespace fs = std::filesystem;
+    std::string base = (fs::temp_directory_path() / "completion_test-XXXXXX").string();
+    if (mkdtemp(base.data()) == nullptr) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    const std::string real = base + "/real";
+    const std::string link = base + "/link";
+    const std::string later = base + "/later";
+    fs::create_directory(real);
+    fs::create_directory_symlink(real, link);
+    createFile(real + "/zzold", 0755);
+
+    {
+        CompletionIndex index;
+        index.setBuiltins({"zzbuiltin"});
+        index.setPath(real + ":" + link + ":" + later);
+        // Файл был при setPath, поэтому он есть в списках и real, и link. Удаление
+        // должно убрать его из обоих: у real и link один watch
+        CHECK(expectNames(index, "zz", {"zzbuiltin", "zzold"}, "initial scan"));
+        fs::remove(real + "/zzold");
+        CHECK(expectNames(index, "zz", {"zzbuiltin"}, "delete scanned"));
+
+        // Создание: исполняемый файл появляется, обычный — нет
+        createFile(real + "/zzfoo", 0755);
+        createFile(real + "/zzdata", 0644);
+        CHECK(expectNames(index, "zz", {"zzbuiltin", "zzfoo"}, "create"));
+
+        fs::remove(real + "/zzfoo");
+        CHECK(expectNames(index, "zz", {"zzbuiltin"}, "delete"));
+
+        createFile(real + "/zzfoo", 0755);
+        CHECK(expectNames(index, "zz", {"zzbuiltin", "zzfoo"}, "recreate"));
+
+        // Директории не было при setPath
+        fs::create_directory(later);
+        createFile(later + "/zzbar", 0755);
+        CHECK(expectNames(index, "zz", {"zzbar", "zzbuiltin", "zzfoo"}, "later"));
+
+        // Директорию удалили и создали заново
+        fs::remove_all(later);
+        CHECK(expectNames(index, "zz", {"zzbuiltin", "zzfoo"}, "directory removed"));
+        fs::create_directory(later);
+        createFile(later + "/zzbaz", 0755);
+        CHECK(expectNames(index, "zz", {"zzbaz", "zzbuiltin", "zzfoo"}, "directory recreated"));
+
+        // Ссылка убрана из PATH: общий watch должен остаться у real
+        index.setPath(real + ":" + later);
+        fs::remove(real + "/zzfoo");
+        CHECK(expectNames(index, "zz", {"zzbaz", "zzbuiltin"}, "alias dropped"));
+        createFile(real + "/zzqux", 0755);
+        CHECK(expectNames(index, "zz", {"zzbaz", "zzbuiltin", "zzqux"}, "alias dropped, create"));
+
+#if defined(__linux__)
+        // Права меняются без создания файла (mtime директории при этом не меняется)
+        fs::permissions(real + "/zzdata", fs::perms::owner_exec, fs::perm_options::add);
+        CHECK(expectNames(index, "zz", {"zzbaz", "zzbuiltin", "zzdata", "zzqux"}, "chmod"));
+#endif
+    }
+
+    fs::remove_all(base);
+    return check::result();
+}
@@ -0,0 +1,75 @@
+#include "check.hpp"
+#include "highlighter.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+
+// Случайные правки строки: подсветка после update должна совпадать с полным разбором
+// reset той же строки. Цепочка правок идёт на одном Highlighter, так что проверяются и
+// контрольные точки, оставшиеся от предыдущих update.
+
+namespace {
+
+// Символы, которые меняют состояние лексера, плюс обычные буквы и цифры
+constexpr std::string_view kAlphabet = "ab_Z9 |'\"$\t";
+
+std::string randomText(std::mt19937 &rng, std::size_t length) {
+    std::uniform_int_distribution<std::size_t> pick(0, kAlphabet.size() - 1);
+    std::string text;
+    for (std::size_t i = 0; i < length; ++i) {
+        text.push_back(kAlphabet[pick(rng)]);
+    }
+    return text;
+}
+
+std::size_t uniform(std::mt19937 &rng, std::size_t low, std::size_t high) {
+    return std::uniform_int_distribution<std::size_t>(low, high)(rng);
+}
+
+bool sameAsReset(const Highlighter &incremental, std::string_view text) {
+    Highlighter full;
+    full.reset(text);
+    return incremental.styles() == full.styles();
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 rng(20260101);  // фиксированное зерно: прогон воспроизводим
+
+    constexpr int kChains = 2000;
+    constexpr int kEditsPerChain = 50;
+    for (int chain = 0; chain < kChains; ++chain) {
+        std::string text = randomText(rng, uniform(rng, 0, 40));
+        Highlighter highlighter;
+        highlighter.reset(text);
+        if (!CHECK(sameAsReset(highlighter, text))) {
+            return check::result();
+        }
+
+        for (int edit = 0; edit < kEditsPerChain; ++edit) {
+            const std::size_t pos = uniform(rng, 0, text.size());
+            const std::size_t removed =
+                uniform(rng, 0, std::min<std::size_t>(text.size() - pos, 4));
+            // Чаще всего — ввод или удаление одного символа, как в редакторе
+            const std::size_t inserted = uniform(rng, 0, 3) == 0 ? uniform(rng, 0, 8)
+                                                                  : uniform(rng, 0, 1);
+            const std::string before = text;
+            text.replace(pos, removed, randomText(rng, inserted));
+
+            highlighter.update(text, pos, removed, inserted);
+            if (!CHECK(sameAsReset(highlighter, text)) ||
+                !CHECK(highlighter.lastScanned() <= text.size())) {
+                std::fprintf(stderr, "before: \"%s\"\nedit: pos %zu, removed %zu, inserted %zu\n"
+                                     "after: \"%s\"\n",
+                             before.c_str(), pos, removed, inserted, text.c_str());
+                return check::result();
+            }
+        }
+    }
+    return check::result();
+}
@@ -0,0 +1,190 @@
+#include "check.hpp"
+#include "history.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <stdlib.h>
+
+// History::search против обратного линейного просмотра тех же записей: до построения
+// индекса, с полным индексом, во втором экземпляре (сегменты с диска), после усечения
+// файла и после ротации (подмены файла). Записей — три полных сегмента и хвост.
+
+namespace {
+
+constexpr std::size_t kEntries = 3 * History::kSegmentEntries + 1000;
+
+std::vector<std::string> makeEntries(std::size_t count, unsigned seed) {
+    static const char *const kWords[] = {"git",  "push",   "cat",    "grep",  "make", "docker",
+                                         "ls",   "-la",    "--force", "origin", "main", "src/",
+                                         "build", "|",     "wc",     "ssh"};
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<std::size_t> word(0, std::size(kWords) - 1);
+    std::uniform_int_distribution<std::size_t> length(1, 5);
+    std::uniform_int_distribution<unsigned> number(0, 999);
+
+    std::vector<std::string> entries;
+    entries.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string line = kWords[word(rng)];
+        for (std::size_t n = length(rng); n > 0; --n) {
+            line += ' ';
+            line += kWords[word(rng)];
+        }
+        line += ' ' + std::to_string(number(rng));
+        entries.push_back(std::move(line));
+    }
+    return entries;
+}
+
+void writeFile(const std::string &path, const std::vector<std::string> &entries) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    for (const std::string &line : entries) {
+        out << line << '\n';
+    }
+}
+
+std::optional<std::size_t> linearSearch(const std::vector<std::string> &entries,
+                                        std::string_view query,
+                                        std::size_t before) {
+    for (std::size_t i = std::min(before, entries.size()); i-- > 0;) {
+        if (entries[i].find(query) != std::string::npos) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+bool waitIndex(History &history) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    while (!history.indexComplete()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+// Все запросы на границах сегментов, рядом с ними и в случайных местах, плюс шаги Ctrl-R
+// от конца к началу для нескольких запросов
+void compare(History &history, const std::vector<std::string> &entries, const char *stage) {
+    if (!CHECK(history.size() == entries.size())) {
+        std::fprintf(stderr, "%s: size %zu, expected %zu\n", stage, history.size(),
+                     entries.size());
+        return;
+    }
+    for (std::size_t i : {std::size_t{0}, entries.size() / 2, entries.size() - 1}) {
+        CHECK(history.entry(i) == entries[i]);
+    }
+
+    const std::vector<std::string> queries = {
+        "gi", "|", "git push", "cat src/", "main 5", "--force 99", "zzz", "ssh wc", "h o",
+        entries[entries.size() / 3], entries.back(), entries.front(),
+    };
+    std::vector<std::size_t> befores = {0, 1, entries.size(), entries.size() + 7};
+    for (std::size_t boundary = History::kSegmentEntries; boundary <= entries.size();
+         boundary += History::kSegmentEntries) {
+        befores.insert(befores.end(), {boundary - 1, boundary, boundary + 1});
+    }
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<std::size_t> anywhere(0, entries.size());
+    for (int i = 0; i < 20; ++i) {
+        befores.push_back(anywhere(rng));
+    }
+
+    for (const std::string &query : queries) {
+        for (const std::size_t before : befores) {
+            const auto expected = linearSearch(entries, query, before);
+            if (!CHECK(history.search(query, before) == expected)) {
+                std::fprintf(stderr, "%s: query \"%s\", before %zu\n", stage, query.c_str(),
+                             before);
+            }
+        }
+    }
+
+    for (const char *query : {"docker ssh", "make 12", "-la |"}) {
+        std::size_t before = entries.size();
+        for (int step = 0; step < 200; ++step) {
+            const auto expected = linearSearch(entries, query, before);
+            if (!CHECK(history.search(query, before) == expected)) {
+                std::fprintf(stderr, "%s: step %d of \"%s\"\n", stage, step, query);
+            }
+            if (!expected) {
+                break;
+            }
+            before = *expected;
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    const std::filesystem::path base = std::filesystem::temp_directory_path();
+    std::string dir = (base / "history_test-XXXXXX").string();
+    if (mkdtemp(dir.data()) == nullptr) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    const std::string path = dir + "/history";
+
+    std::vector<std::string> entries = makeEntries(kEntries, 1);
+    writeFile(path, entries);
+    {
+        History history(path);
+        if (!CHECK(history.open())) {
+            return check::result();
+        }
+        compare(history, entries, "before index");
+        CHECK(waitIndex(history));
+        compare(history, entries, "indexed");
+
+        // Записи, дописанные через add, попадают в неполный последний сегмент
+        for (const std::string &line : makeEntries(100, 2)) {
+            history.add(line);
+            entries.push_back(line);
+        }
+        compare(history, entries, "appended");
+
+        // Второй экземпляр берёт готовые сегменты с диска, без построения
+        History second(path);
+        CHECK(second.open());
+        CHECK(second.indexComplete());
+        compare(second, entries, "second instance");
+
+        // Усечение на месте (тот же inode): записи той же длины, но другие — сегменты на
+        // диске от старого содержимого не должны подойти
+        std::vector<std::string> truncated(entries.begin(),
+                                           entries.begin() + 2 * History::kSegmentEntries + 10);
+        for (std::string &line : truncated) {
+            std::reverse(line.begin(), line.end());
+        }
+        writeFile(path, truncated);
+        compare(history, truncated, "truncated");
+        CHECK(waitIndex(history));
+        compare(history, truncated, "truncated, indexed");
+
+        // Ротация: новый файл подменяет старый по тому же пути
+        const std::vector<std::string> rotated = makeEntries(History::kSegmentEntries + 5, 3);
+        writeFile(path + ".new", rotated);
+        std::filesystem::rename(path + ".new", path);
+        compare(history, rotated, "rotated");
+        CHECK(waitIndex(history));
+        compare(history, rotated, "rotated, indexed");
+    }
+
+    std::filesystem::remove_all(dir);
+    return check::result();
+}
@@ -0,0 +1,103 @@
+#include "check.hpp"
+#include "latency_histogram.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <random>
+
+// Границы диапазонов LatencyHistogram: indexOf и highestValueAt согласованы на обоих
+// краях каждого диапазона, диапазоны идут подряд без пропусков и покрывают весь
+// uint64_t, ширина диапазона не больше 1/64 его нижней границы.
+
+namespace {
+
+constexpr std::uint64_t kMax = std::numeric_limits<std::uint64_t>::max();
+
+// Нижняя граница диапазона index
+std::uint64_t lowestValueAt(std::size_t index) {
+    return index == 0 ? 0 : LatencyHistogram::highestValueAt(index - 1) + 1;
+}
+
+void checkBuckets() {
+    const std::size_t last = LatencyHistogram::indexOf(kMax);
+    // 128 точных значений и по 64 поддиапазона на каждую степень двойки от 2^7 до 2^63
+    CHECK(last + 1 == 128 + 57 * 64);
+    CHECK(LatencyHistogram::highestValueAt(last) == kMax);
+
+    for (std::size_t index = 0; index <= last; ++index) {
+        const std::uint64_t low = lowestValueAt(index);
+        const std::uint64_t high = LatencyHistogram::highestValueAt(index);
+        const bool ok = CHECK(low <= high) && CHECK(LatencyHistogram::indexOf(low) == index) &&
+                        CHECK(LatencyHistogram::indexOf(high) == index) &&
+                        (low < 128 ? CHECK(low == high) : CHECK((high - low + 1) * 64 <= low));
+        if (!ok) {
+            std::fprintf(stderr, "bucket %zu: [%llu, %llu]\n", index,
+                         static_cast<unsigned long long>(low),
+                         static_cast<unsigned long long>(high));
+            return;
+        }
+    }
+}
+
+void checkPowersOfTwo() {
+    for (unsigned bit = 0; bit < 64; ++bit) {
+        const std::uint64_t power = std::uint64_t{1} << bit;
+        for (const std::uint64_t value : {power - 1, power, power + 1}) {
+            const std::size_t index = LatencyHistogram::indexOf(value);
+            const bool ok = CHECK(lowestValueAt(index) <= value) &&
+                            CHECK(value <= LatencyHistogram::highestValueAt(index)) &&
+                            CHECK(LatencyHistogram::indexOf(value + 1) - index <= 1);
+            if (!ok) {
+                std::fprintf(stderr, "value %llu\n", static_cast<unsigned long long>(value));
+                return;
+            }
+        }
+    }
+}
+
+void checkRandomValues() {
+    std::mt19937_64 rng(42);
+    for (int i = 0; i < 100000; ++i) {
+        // Равномерно по числу значащих бит, а не по значению: иначе почти все значения
+        // попали бы в старшие диапазоны
+        const std::uint64_t value = rng() >> (rng() % 64);
+        const std::size_t index = LatencyHistogram::indexOf(value);
+        if (!CHECK(lowestValueAt(index) <= value) ||
+            !CHECK(value <= LatencyHistogram::highestValueAt(index))) {
+            std::fprintf(stderr, "value %llu\n", static_cast<unsigned long long>(value));
+            return;
+        }
+    }
+}
+
+void checkPercentiles() {
+    LatencyHistogram histogram;
+    CHECK(histogram.percentile(0.5) == 0);
+
+    for (std::uint64_t value = 1; value <= 1000; ++value) {
+        histogram.record(value * 1000);
+    }
+    CHECK(histogram.count() == 1000);
+    CHECK(histogram.max() == 1000000);
+    CHECK(histogram.percentile(1.0) == 1000000);
+    // p50 — 500-е значение (500 000), округлённое вверх до границы его диапазона
+    const std::uint64_t median = histogram.percentile(0.5);
+    CHECK(median == LatencyHistogram::highestValueAt(LatencyHistogram::indexOf(500000)));
+    CHECK(median >= 500000 && (median - 500000) * 64 <= 500000);
+
+    histogram.record(kMax);
+    CHECK(histogram.max() == kMax);
+    CHECK(histogram.percentile(1.0) == kMax);
+}
+
+}  // namespace
+
+int main() {
+    checkBuckets();
+    checkPowersOfTwo();
+    checkRandomValues();
+    checkPercentiles();
+    return check::result();
+}